@@ -0,0 +1,58 @@
+#ifndef HARDWARESENSORSOURCE_H
+#define HARDWARESENSORSOURCE_H
+
+// We have to fix a conflict between the two Seeed Libraries
+#define SEEED_PM2_5_SENSOR_HM3301_HM330X_ERROR_CODE_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <Seeed_SHT35.h>
+#include <TCA9548.h>
+
+typedef err_t HM330XErrorCode;
+
+#include <Seeed_HM330X.h>
+#include "SensorSource.h"
+
+// The SHT35 and HM3301 sensors on the board's I2C bus, optionally behind a
+// TCA9548 multiplexer. Each access selects the sensor's channel first and
+// disables it again afterwards.
+class HardwareSensorSource : public SensorSource {
+public:
+    HardwareSensorSource(bool multiplexerEnabled, uint8_t multiplexerAddress = 0x70);
+
+    ~HardwareSensorSource() override;
+
+    void addTemperatureHumiditySensor(const std::string &name, uint8_t channel, uint8_t address) override;
+
+    void addDustSensor(const std::string &name, uint8_t channel, uint8_t address) override;
+
+    bool begin() override;
+
+    int8_t initSensor(const std::string &name) override;
+
+    bool ready(const std::string &name) override;
+
+    int8_t readTemperatureHumidity(const std::string &name, float &celsius, float &humidity) override;
+
+    int8_t readDust(const std::string &name, uint8_t *frame) override;
+
+private:
+    template<typename Sensor>
+    struct Attached {
+        std::unique_ptr<Sensor> sensor;
+        uint8_t channel;
+    };
+
+    bool multiplexerEnabled;
+    TCA9548 multiplexer;
+    std::map<std::string, Attached<SHT35>> temperatureHumiditySensors;
+    std::map<std::string, Attached<HM330X>> dustSensors;
+
+    void selectChannel(uint8_t channel);
+
+    void disableChannel(uint8_t channel);
+};
+
+#endif
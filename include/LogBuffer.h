@@ -0,0 +1,79 @@
+#ifndef LOGBUFFER_H
+#define LOGBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "RtcEpoch.h"
+
+// OTLP SeverityNumber values for the SerialLogger levels. Only WARN and above
+// are buffered.
+#define LOG_SEVERITY_DEBUG 5
+#define LOG_SEVERITY_INFO  9
+#define LOG_SEVERITY_WARN  13
+#define LOG_SEVERITY_ERROR 17
+
+struct LogRecord {
+    static const size_t MESSAGE_LENGTH = 96;
+
+    unsigned long epoch;        // first occurrence (RTC seconds, GMT)
+    unsigned long lastEpoch;    // most recent occurrence folded into this record
+    unsigned long uptimeMs;     // millis() at the first occurrence
+    unsigned long lastUptimeMs; // millis() at the most recent occurrence
+    uint16_t count;             // number of identical messages folded in
+    uint8_t severityNumber;
+    char message[MESSAGE_LENGTH];
+};
+
+// Fixed-size in-RAM buffer of WARNING/ERROR log records awaiting export, fed by
+// SerialLogger and drained by OtlpHttpExporter alongside each metric publish.
+//
+// Identical messages (same severity + text) are folded into one record with a
+// repeat count, and at most `maxNewPerWindow` new records are accepted per
+// `windowMs`, so a flapping sensor cannot flood the buffer. When full, the
+// oldest record is overwritten. Records lost either way are counted and
+// reported as one synthetic record on the next export.
+class LogBuffer {
+public:
+    static const size_t CAPACITY = 12;
+
+    LogBuffer(uint8_t maxNewPerWindow = 6, unsigned long windowMs = 60000);
+
+    void add(unsigned long epoch, unsigned long nowMs, uint8_t severityNumber, const char *message);
+
+    size_t size() const;
+
+    bool empty() const;
+
+    // Serializes the first `count` records (oldest first) as an OTLP/HTTP JSON
+    // ExportLogsServiceRequest. Nothing is removed; call discard() once the
+    // export has been accepted.
+    //
+    // Records logged before the first NTP sync carry the RTC's year-2000 time,
+    // which log backends reject as too old. They are restamped from the uptime
+    // elapsed since, relative to `epoch`/`nowMs` (the time of the export), or
+    // sent with an unknown (0) time if the clock is still not set.
+    std::string toOtlpJson(const char *serviceName, size_t count, unsigned long epoch, unsigned long nowMs) const;
+
+    // Drops the `count` oldest records (and the dropped-record tally that was
+    // exported with them).
+    void discard(size_t count);
+
+private:
+    LogRecord records[CAPACITY];
+    size_t head;
+    size_t count;
+    uint8_t maxNewPerWindow;
+    unsigned long windowMs;
+    unsigned long windowStart;
+    uint8_t windowCount;
+    uint32_t dropped;
+    unsigned long droppedEpoch;
+    unsigned long droppedUptimeMs;
+
+    LogRecord &at(size_t index);
+
+    const LogRecord &at(size_t index) const;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef METRICEXPORTER_H
+#define METRICEXPORTER_H
+
+#include <vector>
+
+// One gauge sample produced by SensorService. `metric` is a string literal;
+// `sensorName` and `location` point at the name and location strings held in
+// the SensorService sensor maps, which are never removed from, so a point
+// stays valid for as long as the SensorService that produced it.
+struct MetricPoint {
+    const char *metric;         // e.g. "environment.temperature_fahrenheit"
+    double value;
+    unsigned long epoch;        // RTC time (GMT) the sample was taken, in seconds
+    const char *sensorName;
+    const char *location;
+};
+
+// Transport-agnostic sink for a batch of sensor readings. SensorService builds
+// the batch; the exporter owns the wire format and the network I/O.
+class MetricExporter {
+public:
+    virtual ~MetricExporter() = default;
+
+    // Sends one batch. Returns a transport status (the HTTP status code for
+    // OTLP/HTTP, the number of datagrams sent for UDP); negative on failure.
+    virtual int exportMetrics(const std::vector<MetricPoint> &points) = 0;
+
+    // Whether a status returned by exportMetrics() means the batch was taken
+    // and need not be sent again.
+    virtual bool accepted(int statusCode) const {
+        return statusCode >= 0;
+    }
+};
+
+#endif
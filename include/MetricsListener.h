@@ -0,0 +1,21 @@
+#ifndef METRICSLISTENER_H
+#define METRICSLISTENER_H
+
+#include <Client.h>
+
+// The listening socket MetricsServer takes scrapes from: the NINA module's
+// server socket on the board (WiFiMetricsListener), a host socket in the
+// native tests.
+class MetricsListener {
+public:
+    virtual ~MetricsListener() = default;
+
+    // Starts listening; called whenever the WiFi connection comes up.
+    virtual void begin() = 0;
+
+    // A newly connected client, or nullptr if none is waiting. The client
+    // stays valid until it is stopped and accept() is called again.
+    virtual Client *accept() = 0;
+};
+
+#endif
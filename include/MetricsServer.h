@@ -0,0 +1,53 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include "MetricsListener.h"
+#include "MetricsSnapshot.h"
+
+// Minimal HTTP server answering `GET /metrics` with the latest MetricsSnapshot,
+// for sites without a Collector that scrape the board directly.
+//
+// poll() is called from loop() and never waits on the network: it reads only
+// the request bytes that have already arrived and picks up the rest on later
+// calls, then answers from the pre-rendered snapshot. It never touches the
+// sensors, so a slow client cannot stall the sampling loop.
+class MetricsServer {
+public:
+    MetricsServer(MetricsListener &listener, const MetricsSnapshot &snapshot);
+
+    // Starts listening; call whenever the WiFi connection comes up.
+    void begin();
+
+    void poll();
+
+private:
+    // How long a client may take to send its request line before it is
+    // dropped. Only bounds the wait; no single poll() blocks for it.
+    static const unsigned long REQUEST_TIMEOUT_MS = 2000;
+
+    // Total time one response may take to write out. A write to a client that
+    // stopped reading can block for ~2.5 s inside WiFiNINA, so this is checked
+    // between writes and may be overrun by one such stall.
+    static const unsigned long RESPONSE_TIMEOUT_MS = 3000;
+
+    // Bytes per write; the NINA module's SPI transfer buffer is limited.
+    static const size_t RESPONSE_CHUNK = 512;
+
+    MetricsListener &listener;
+    const MetricsSnapshot &snapshot;
+    bool started;
+
+    // The request currently being read, one client at a time; nullptr when
+    // idle.
+    Client *client;
+    char requestLine[64];
+    size_t requestLength;
+    unsigned long requestStarted;
+
+    // Writes the status line and headers together with the start of the body,
+    // then the rest of the body, RESPONSE_CHUNK bytes per write. Gives up on
+    // the first short or failed write, or once RESPONSE_TIMEOUT_MS is spent.
+    void respond(const char *status, const std::string &body);
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef METRICSSNAPSHOT_H
+#define METRICSSNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MetricExporter.h"
+
+// Latest readings, pre-rendered in the Prometheus text exposition format.
+//
+// SensorService calls publish() after each acquisition; it renders into the
+// back buffer and then flips it to the front, so a scrape that is still
+// writing out the previous front buffer is never handed a half-rendered one.
+// Scrapes only ever copy bytes out of current(): any number of scrapers adds
+// no sensor (I2C) load and no rendering work.
+class MetricsSnapshot {
+public:
+    MetricsSnapshot();
+
+    void publish(const std::vector<MetricPoint> &points);
+
+    // Exposition text of the most recent publish (empty before the first).
+    // Remains valid until the next-but-one publish.
+    const std::string &current() const;
+
+    // Incremented on every publish; 0 until the first.
+    uint32_t generation() const;
+
+    static std::string render(const std::vector<MetricPoint> &points);
+
+private:
+    std::string buffers[2];
+    volatile uint8_t front;
+    volatile uint32_t published;
+};
+
+#endif
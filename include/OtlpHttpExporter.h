@@ -0,0 +1,50 @@
+#ifndef OTLPHTTPEXPORTER_H
+#define OTLPHTTPEXPORTER_H
+
+#include <string>
+#include <Client.h>
+#include <ArduinoHttpClient.h>
+#include <RTCZero.h>
+#include "LogBuffer.h"
+#include "MetricExporter.h"
+#include "SerialLogger.h"
+
+// Posts each batch as an OTLP/HTTP JSON ExportMetricsServiceRequest to an
+// OpenTelemetry Collector. One TCP connection per batch; buffered log records,
+// if any, follow as an ExportLogsServiceRequest on the same keep-alive
+// connection so they never cost an extra handshake.
+class OtlpHttpExporter : public MetricExporter {
+public:
+    OtlpHttpExporter(Client &client, SerialLogger &logger, const char *host, int port, const char *metricsPath,
+                     const char *serviceName, uint32_t responseTimeoutMs);
+
+    int exportMetrics(const std::vector<MetricPoint> &points) override;
+
+    // Only a 2xx response means the Collector took the batch.
+    bool accepted(int statusCode) const override;
+
+    // Drain `buffer` to `logsPath` (e.g. "/v1/logs") after each metric post.
+    void setLogBuffer(LogBuffer *buffer, const char *logsPath);
+
+private:
+    // Skip the logs post when less than this is left of the response timeout
+    // after the metrics post.
+    static const uint32_t MIN_LOGS_BUDGET_MS = 1000;
+
+    RTCZero rtc;
+    Client &client;
+    SerialLogger &logger;
+    const char *host;
+    int port;
+    const char *metricsPath;
+    const char *serviceName;
+    uint32_t responseTimeoutMs;
+    LogBuffer *logBuffer;
+    const char *logsPath;
+
+    std::string serializeMetrics(const std::vector<MetricPoint> &points) const;
+
+    int post(HttpClient &httpClient, const char *path, const std::string &body);
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef RTCEPOCH_H
+#define RTCEPOCH_H
+
+// The RTC starts at 2000-01-01 after a reset and is only set from NTP once
+// WiFi is up, so an epoch before 2020-01-01 was read before that first sync.
+#define RTC_MIN_VALID_EPOCH 1577836800UL
+
+inline bool rtcEpochValid(unsigned long epoch) {
+    return epoch >= RTC_MIN_VALID_EPOCH;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SENSORFRAMES_H
+#define SENSORFRAMES_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Hardware-independent decoding of raw sensor results. SensorService uses these
+// on the device and the trace replay tool uses them on a host, so a replayed
+// trace runs the same conversion and validation code as the firmware.
+
+#define DUST_FRAME_LENGTH 29
+
+struct DustReading {
+    uint16_t pm1_0_spm;
+    uint16_t pm2_5_spm;
+    uint16_t pm10_spm;
+    uint16_t pm1_0_ae;
+    uint16_t pm2_5_ae;
+    uint16_t pm10_ae;
+};
+
+// Validates the HM3301 checksum (byte 28 = sum of bytes 0..27) and, if it
+// matches, parses the six concentrations out of `frame`. Returns false (and
+// leaves `reading` untouched) on a checksum mismatch.
+bool decodeDustFrame(const uint8_t *frame, DustReading &reading);
+
+// SHT35 raw 16-bit words <-> physical units, using the same formulas as the
+// Seeed SHT35 driver. At 16-bit resolution the conversion is exactly
+// invertible, so raw words can be recovered from the driver's float results.
+float shtTemperatureFromRaw(uint16_t raw);
+float shtHumidityFromRaw(uint16_t raw);
+uint16_t shtRawFromTemperature(float celsius);
+uint16_t shtRawFromHumidity(float humidity);
+
+float fahrenheitFromCelsius(float celsius);
+
+#endif
@@ -1,48 +1,47 @@
 #ifndef SENSORSERVICE_H
 #define SENSORSERVICE_H
 
-// We have to fix a conflict between the two Seeed Libraries
-#define SEEED_PM2_5_SENSOR_HM3301_HM330X_ERROR_CODE_H
-
 #include <map>
-#include <memory>
 #include <string>
+#include <tuple>
+#include <vector>
 #include <RTCZero.h>
-#include <Seeed_SHT35.h>
-#include <TCA9548.h>
-
-typedef err_t HM330XErrorCode;
-
-#include <Seeed_HM330X.h>
+#include "MetricExporter.h"
+#include "MetricsSnapshot.h"
+#include "RtcEpoch.h"
+#include "SensorSource.h"
+#include "SensorTrace.h"
 #include "SerialLogger.h"
 
 struct TempHumditySensor {
     TempHumditySensor();
-    TempHumditySensor(std::unique_ptr<SHT35> sensor, std::string location);
-    TempHumditySensor(std::unique_ptr<SHT35> sensor, ushort channel, std::string location);
+    TempHumditySensor(std::string location);
+    TempHumditySensor(ushort channel, std::string location);
 
-    std::unique_ptr<SHT35> sensor;
     bool usesMultiplexer;
     ushort multiplierChannel;
     std::string location;
+    unsigned long samplingPeriodMs;     // 0 = sample on every tick
+    unsigned long nextSampleMs;
 };
 
 struct DustSensor {
     DustSensor();
-    DustSensor(std::unique_ptr<HM330X> sensor, std::string location);
-    DustSensor(std::unique_ptr<HM330X> sensor, ushort channel, std::string location);
+    DustSensor(std::string location);
+    DustSensor(ushort channel, std::string location);
 
-    std::unique_ptr<HM330X> sensor;
     bool usesMultiplexer;
     ushort multiplierChannel;
     std::string location;
+    unsigned long samplingPeriodMs;     // 0 = sample on every tick
+    unsigned long nextSampleMs;
 };
 
 class SensorService {
 public:
-    SensorService(SerialLogger &logger, bool multiplexerEnabled, uint8_t multiplexerAddress = 0x70);
-
-    ~SensorService();
+    // Readings come from `source`: the board's sensors, or a recorded trace
+    // when replaying on a host.
+    SensorService(SerialLogger &logger, SensorSource &source);
 
     SensorService *addTemperatureHumiditySensor(std::string name, std::string location, uint8_t IIC_ADDR);
     SensorService *addTemperatureHumiditySensor(std::string name, std::string location, ushort channel, uint8_t IIC_ADDR);
@@ -56,16 +55,67 @@ public:
 
     bool InitializeSensors();
 
-    int readAndPublishSensors(int(*publish)(const std::string& str), const char* serviceName);
+    // Sets the sampling period of every sensor of each type and staggers their
+    // first reads, so reads land on different ticks instead of bursting
+    // together. The dust sensors are spread evenly across their period. The
+    // temperature/humidity sensors sit halfway between two dust reads and are
+    // spaced by whole dust intervals, which keeps them off the dust ticks as
+    // long as their period is a multiple of that interval. Call after all
+    // sensors have been added.
+    void setSamplingPeriods(unsigned long temperatureHumidityPeriodMs, unsigned long dustPeriodMs);
+
+    // Same, starting from an explicit uptime (tests).
+    void setSamplingPeriods(unsigned long temperatureHumidityPeriodMs, unsigned long dustPeriodMs,
+                            unsigned long now);
+
+    // Reads every sensor whose sampling period has elapsed and queues the
+    // readings for the next publish. Call on a fixed tick; returns the number
+    // of sensors read.
+    int sampleSensors();
+
+    // Same, at an explicit uptime and RTC epoch (trace replay).
+    int sampleSensors(unsigned long now, unsigned long epoch);
+
+    // Exports the oldest queued readings, at most MAX_POINTS_PER_EXPORT of
+    // them, and removes them from the queue only if the exporter accepted the
+    // batch; otherwise they are retried on the next publish. A backlog left by
+    // an outage drains over the following publishes, one bounded batch each.
+    // Returns the exporter status, or 0 if nothing was queued.
+    int publishSamples(MetricExporter &exporter);
+
+    // Number of readings waiting to be published.
+    size_t pendingSamples() const;
+
+    // Records every raw read (and a marker per acquisition cycle) to `writer`
+    // (nullptr disables).
+    void setTraceWriter(SensorTraceWriter *writer);
+
+    // Publishes the latest reading of every sensor to `snapshot` after each
+    // sampling tick, for local scraping (nullptr disables).
+    void setMetricsSnapshot(MetricsSnapshot *snapshot);
 
 private:
+    // Bounds the publish queue while the network is down; the oldest readings
+    // are dropped first.
+    static const size_t MAX_PENDING_POINTS = 120;
+
+    // Points per export. Bounds the request body the exporter builds (about
+    // 185 bytes of OTLP JSON per point) while still covering one publish
+    // interval's worth of readings.
+    static const size_t MAX_POINTS_PER_EXPORT = 24;
+
     RTCZero rtc;
-    bool multiplexerEnabled;
-    TCA9548 multiplexer;
+    SensorSource &source;
     std::map<std::string, TempHumditySensor> temperatureHumiditySensors;
     std::map<std::string, DustSensor> dustSensors;
     uint8_t dustSensorBuffer[30];
     SerialLogger &logger;
+    SensorTraceWriter *traceWriter;
+    MetricsSnapshot *metricsSnapshot;
+    std::vector<MetricPoint> pendingPoints;
+    std::vector<MetricPoint> latestPoints;
+
+    void addSample(const MetricPoint &point);
 };
 
 #endif
\ No newline at end of file
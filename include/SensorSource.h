@@ -0,0 +1,45 @@
+#ifndef SENSORSOURCE_H
+#define SENSORSOURCE_H
+
+#include <cstdint>
+#include <string>
+
+// Channel value for sensors wired directly to the bus rather than through the
+// TCA9548 (same value the trace records).
+#define SENSOR_NO_CHANNEL 0xFF
+
+// Driver status for a successful init or read (the Seeed err_t NO_ERROR).
+#define SENSOR_OK 0
+
+// Where SensorService gets its raw readings: the I2C sensors on the board
+// (HardwareSensorSource) or a recorded trace replayed on a host
+// (TraceSensorSource). Sensors are addressed by name; channel selection and
+// the drivers themselves stay behind this interface.
+class SensorSource {
+public:
+    virtual ~SensorSource() = default;
+
+    virtual void addTemperatureHumiditySensor(const std::string &name, uint8_t channel, uint8_t address) = 0;
+
+    virtual void addDustSensor(const std::string &name, uint8_t channel, uint8_t address) = 0;
+
+    // Brings up the bus (the multiplexer, if any). Returns false on failure.
+    virtual bool begin() = 0;
+
+    // Initializes one sensor; returns the driver status.
+    virtual int8_t initSensor(const std::string &name) = 0;
+
+    // Whether `name` can be read on this tick. The hardware always can; a
+    // trace only has the reads recorded in its current cycle.
+    virtual bool ready(const std::string &name) = 0;
+
+    // Reads an SHT35 in °C and %RH and returns the driver status. On failure
+    // the outputs are left as they were.
+    virtual int8_t readTemperatureHumidity(const std::string &name, float &celsius, float &humidity) = 0;
+
+    // Reads a raw HM3301 frame (DUST_FRAME_LENGTH bytes) into `frame` and
+    // returns the driver status.
+    virtual int8_t readDust(const std::string &name, uint8_t *frame) = 0;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef SENSORTRACE_H
+#define SENSORTRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SensorFrames.h"
+
+// Compact binary trace of raw sensor results, for reproducing field problems
+// (checksum failures, bad SHT35 reads) on a bench. A trace is a sequence of
+// self-delimiting records; multi-byte integers are little-endian.
+//
+//   'H' magic "ENVT", version u8                             header, once
+//   'S' index u8, kind u8, channel u8, nameLength u8, name   sensor definition
+//   'C' epoch u32, uptimeMs u32                              start of a cycle
+//   'T' index u8, status i8, durationUs u16, rawT u16, rawH u16   SHT35 read
+//   'D' index u8, status i8, durationUs u16, frame[29]            HM3301 read
+//
+// A sensor definition precedes the first frame that references its index.
+// The header and every definition so far are written again every
+// TRACE_RESYNC_CYCLES cycles (and on resynchronize()), just before a 'C'
+// record, so a capture that starts or reconnects mid-run becomes decodable
+// from the next header on. A reader may see the same definition repeatedly.
+// channel is the TCA9548 channel, or TRACE_NO_CHANNEL when not multiplexed.
+// status is the driver's err_t (0 = NO_ERROR); durationUs saturates at 65535.
+
+#define TRACE_VERSION 1
+#define TRACE_NO_CHANNEL 0xFF
+#define TRACE_RESYNC_CYCLES 60
+
+#define TRACE_RECORD_HEADER 'H'
+#define TRACE_RECORD_SENSOR 'S'
+#define TRACE_RECORD_CYCLE 'C'
+#define TRACE_RECORD_TEMPERATURE_HUMIDITY 'T'
+#define TRACE_RECORD_DUST 'D'
+
+#define TRACE_KIND_SHT35 1
+#define TRACE_KIND_HM3301 2
+
+// Emits trace records through `sink`, one complete record per call.
+class SensorTraceWriter {
+public:
+    typedef void (*Sink)(const uint8_t *record, size_t length);
+
+    explicit SensorTraceWriter(Sink sink);
+
+    void cycle(uint32_t epoch, uint32_t uptimeMs);
+
+    // Writes the header and all sensor definitions again before the next
+    // cycle, e.g. when a serial monitor has just attached.
+    void resynchronize();
+
+    void temperatureHumidity(const std::string &name, uint8_t channel, int8_t status, uint32_t durationUs,
+                             uint16_t rawTemperature, uint16_t rawHumidity);
+
+    void dust(const std::string &name, uint8_t channel, int8_t status, uint32_t durationUs, const uint8_t *frame);
+
+private:
+    struct Sensor {
+        std::string name;
+        uint8_t kind;
+        uint8_t channel;
+    };
+
+    Sink sink;
+    bool synchronized;
+    uint16_t cyclesSinceSync;
+    std::vector<Sensor> sensors;
+
+    uint8_t sensorIndex(const std::string &name, uint8_t kind, uint8_t channel);
+
+    void writeDefinition(uint8_t index);
+};
+
+struct TraceRecord {
+    uint8_t type;
+    uint8_t version;
+    uint8_t sensorIndex;
+    uint8_t kind;
+    uint8_t channel;
+    std::string name;
+    uint32_t epoch;
+    uint32_t uptimeMs;
+    int8_t status;
+    uint16_t durationUs;
+    uint16_t rawTemperature;
+    uint16_t rawHumidity;
+    uint8_t frame[DUST_FRAME_LENGTH];
+};
+
+// Iterates the records of an in-memory trace.
+class SensorTraceReader {
+public:
+    SensorTraceReader(const uint8_t *data, size_t length);
+
+    // Decodes the next record. Returns false at the end of the trace or on a
+    // truncated/unknown record (see failed()).
+    bool next(TraceRecord &record);
+
+    bool failed() const;
+
+    size_t offset() const;
+
+private:
+    const uint8_t *data;
+    size_t length;
+    size_t position;
+    bool error;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <RTCZero.h>
 #include <LibPrintf.h>
+#include "LogBuffer.h"
 
 #define LOG_LEVEL_DEBUG "[DEBUG]"
 #define LOG_LEVEL_INFO "[INFO]"
@@ -26,13 +27,18 @@ public:
 
     void LogNetworkInformation();
 
+    // Also records WARNING and ERROR messages in `buffer` for remote export
+    // (nullptr disables).
+    void setLogBuffer(LogBuffer *buffer);
+
 private:
     RTCZero rtc;
     Print &PrintClass;
+    LogBuffer *logBuffer;
 
     void printTime();
 
-    void printMessage(const char *logLevel, const char *format, va_list args);
+    void printMessage(const char *logLevel, uint8_t severityNumber, const char *format, va_list args);
 
     void printMacAddress(byte mac[]);
 };
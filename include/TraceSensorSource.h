@@ -0,0 +1,92 @@
+#ifndef TRACESENSORSOURCE_H
+#define TRACESENSORSOURCE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "MetricExporter.h"
+#include "SensorService.h"
+#include "SensorSource.h"
+#include "SensorTrace.h"
+
+struct TraceReplayStats {
+    unsigned long cycles;
+    unsigned long temperatureHumidityReads;
+    unsigned long dustReads;
+    unsigned long readFailures;
+    unsigned long checksumFailures;
+    uint16_t maxTemperatureHumidityUs;
+    uint16_t maxDustUs;
+};
+
+// Serves the reads recorded in a sensor trace (see SensorTrace.h) in place of
+// the hardware, so a field capture can be replayed on a host through the
+// firmware's own SensorService: scheduling, decoding, queueing and publishing.
+class TraceSensorSource : public SensorSource {
+public:
+    TraceSensorSource(const uint8_t *data, size_t length);
+
+    // Replays the whole trace through `service`, which must read from this
+    // source. Every sensor the trace defines is added to `service` (with an
+    // empty location); every recorded cycle becomes one sampling tick at the
+    // recorded uptime and epoch, after which everything it queued is
+    // published to `exporter`. Returns false on a malformed trace, including
+    // a read from a sensor the trace has not defined (see errorOffset()). A
+    // source replays once.
+    bool replay(SensorService &service, MetricExporter &exporter);
+
+    const TraceReplayStats &stats() const;
+
+    size_t errorOffset() const;
+
+    // The sensors come from the trace's own definitions; these are no-ops.
+    void addTemperatureHumiditySensor(const std::string &name, uint8_t channel, uint8_t address) override;
+
+    void addDustSensor(const std::string &name, uint8_t channel, uint8_t address) override;
+
+    bool begin() override;
+
+    int8_t initSensor(const std::string &name) override;
+
+    // True only for sensors with a read recorded in the current cycle.
+    bool ready(const std::string &name) override;
+
+    int8_t readTemperatureHumidity(const std::string &name, float &celsius, float &humidity) override;
+
+    int8_t readDust(const std::string &name, uint8_t *frame) override;
+
+private:
+    SensorTraceReader reader;
+    bool malformed;
+    size_t malformedOffset;
+    std::vector<std::string> names;
+    std::map<std::string, TraceRecord> reads;
+    TraceReplayStats statistics;
+
+    void defineSensor(SensorService &service, const TraceRecord &record);
+
+    void runCycle(SensorService &service, MetricExporter &exporter, const TraceRecord &cycle);
+};
+
+// Stands in for the network exporter during a replay. Each batch is encoded
+// as the line protocol UdpLineExporter would send and folded into an FNV-1a
+// digest, so the digest covers the name, value, sensor and timestamp of every
+// published point: a change that preserves behaviour keeps it identical.
+class TraceDigestExporter : public MetricExporter {
+public:
+    TraceDigestExporter();
+
+    // Returns the number of datagrams the batch would have taken.
+    int exportMetrics(const std::vector<MetricPoint> &points) override;
+
+    uint64_t digest() const;
+
+    unsigned long points() const;
+
+private:
+    uint64_t value;
+    unsigned long exported;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef UDPLINEEXPORTER_H
+#define UDPLINEEXPORTER_H
+
+#include <string>
+#include <IPAddress.h>
+#include <Udp.h>
+#include "MetricExporter.h"
+
+// Fire-and-forget exporter: writes each batch as InfluxDB line protocol over
+// UDP (Telegraf socket_listener, InfluxDB UDP input, ...). No handshake and no
+// response to wait on, so a publish costs only the time to hand the datagrams
+// to the radio. Delivery is best-effort.
+class UdpLineExporter : public MetricExporter {
+public:
+    // 1500-byte Ethernet MTU minus the IPv4 (20) and UDP (8) headers, so no
+    // datagram is ever IP-fragmented.
+    static const size_t DEFAULT_MAX_DATAGRAM = 1472;
+
+    UdpLineExporter(UDP &udp, const char *host, uint16_t port, size_t maxDatagram = DEFAULT_MAX_DATAGRAM);
+
+    // Fails (returns -1) without sending if the host given to the constructor
+    // was not a valid dotted-quad IP.
+    int exportMetrics(const std::vector<MetricPoint> &points) override;
+
+    bool hostValid() const;
+
+    // Formats `points` as line protocol and packs whole lines into datagrams of
+    // at most `maxDatagram` bytes. Consecutive points from the same sensor and
+    // timestamp share one line (one field per metric).
+    static std::vector<std::string> packDatagrams(const std::vector<MetricPoint> &points, size_t maxDatagram);
+
+private:
+    UDP &udp;
+    IPAddress host;
+    bool validHost;
+    uint16_t port;
+    size_t maxDatagram;
+};
+
+#endif
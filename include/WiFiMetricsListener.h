@@ -0,0 +1,24 @@
+#ifndef WIFIMETRICSLISTENER_H
+#define WIFIMETRICSLISTENER_H
+
+#include <WiFiNINA.h>
+#include "MetricsListener.h"
+
+// MetricsListener on a WiFiNINA server socket.
+class WiFiMetricsListener : public MetricsListener {
+public:
+    explicit WiFiMetricsListener(uint16_t port);
+
+    // Listens again only if the module no longer has the socket open
+    // (WiFi.end() resets the NINA module and drops it).
+    void begin() override;
+
+    Client *accept() override;
+
+private:
+    WiFiServer server;
+    bool started;
+    WiFiClient client;
+};
+
+#endif
@@ -10,6 +10,46 @@
 #define OTEL_COLLECTOR_PORT  4318
 #define OTEL_SERVICE_NAME    "arduino-environment-iot"
 
+// Sampling and publishing cadence (ms). Sensors are sampled on a fixed tick,
+// each type at its own period; everything sampled since the last publish goes
+// out together every PUBLISH_INTERVAL_MS. The HM3301 is read often to catch PM
+// events; the SHT35s change slowly, but must stay under Prometheus' 5-minute
+// staleness window.
+#define SAMPLING_TICK_MS                   (1000 * 5)
+#define DUST_SAMPLING_PERIOD_MS            (1000 * 10)
+#define TEMP_HUMIDITY_SAMPLING_PERIOD_MS   (1000 * 60 * 2)
+#define PUBLISH_INTERVAL_MS                (1000 * 30)
+
+// Metrics exporter, selected at build time (override with
+// -DMETRICS_EXPORTER=... in build_flags): OTLP/HTTP JSON to the Collector, or
+// fire-and-forget UDP datagrams in InfluxDB line protocol for high-rate sampling
+// where the per-publish TCP + HTTP round trip is too slow.
+#define EXPORTER_OTLP_HTTP   1
+#define EXPORTER_UDP_LINE    2
+#ifndef METRICS_EXPORTER
+#define METRICS_EXPORTER     EXPORTER_OTLP_HTTP
+#endif
+
+// Line-protocol UDP listener (e.g. Telegraf socket_listener), used when
+// METRICS_EXPORTER == EXPORTER_UDP_LINE. Must be a dotted-quad IP.
+#define UDP_LINE_COLLECTOR_HOST  "10.10.4.234"
+#define UDP_LINE_COLLECTOR_PORT  8089
+
+// Set to 1 (or -DSENSOR_TRACE_CAPTURE=1) to stream a binary trace of every raw
+// sensor read over Serial as "TRC <hex>" lines, for bench replay with
+// tools/trace_replay (see docs/TRACING.md).
+#ifndef SENSOR_TRACE_CAPTURE
+#define SENSOR_TRACE_CAPTURE 0
+#endif
+
+// Set to 1 (or -DMETRICS_SERVER_ENABLED=1) to serve the latest readings in
+// Prometheus format at http://<board-ip>:METRICS_SERVER_PORT/metrics, for sites
+// without a Collector.
+#ifndef METRICS_SERVER_ENABLED
+#define METRICS_SERVER_ENABLED 0
+#endif
+#define METRICS_SERVER_PORT  9464
+
 std::map<const char *, std::tuple<const char*, bool, ushort, uint8_t>> tempHumiditySensors = {
         {"sensor1", {"crawlspace", true, 0, 0x45}},
         {"sensor2", {"crawlspace", true, 1, 0x45}},
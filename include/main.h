@@ -13,22 +13,28 @@ extern const char PASS[];               // Network password (use for WPA, or use
 extern const char OTEL_HOST[];          // OpenTelemetry Collector host/IP on the LAN
 extern const int OTEL_PORT;             // Collector OTLP/HTTP port (e.g. 4318)
 extern const char OTEL_METRICS_PATH[];  // OTLP metrics path ("/v1/metrics")
+extern const char OTEL_LOGS_PATH[];     // OTLP logs path ("/v1/logs")
 extern const char OTEL_SVC_NAME[];      // OTLP resource service.name
 
+extern const char UDP_LINE_HOST[];      // Line-protocol UDP listener IP (EXPORTER_UDP_LINE)
+extern const uint16_t UDP_LINE_PORT;    // Line-protocol UDP listener port
+
 extern int status;                      // the Wifi radio's status
 
 void setup();
 
 void loop();
 
-bool readSensors(void *argument);
+bool sampleSensors(void *argument);
+
+bool publishSensors(void *argument);
 
 void onNetworkConnect();
 
 bool setRTC(void *argument);
 void setRTC(bool waitOnRTC);
 
-int publishMessage(const std::string& str);
+void writeTraceRecord(const uint8_t *record, size_t length);
 
 /*SAMD core*/
 #ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
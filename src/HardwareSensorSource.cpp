@@ -0,0 +1,100 @@
+#include "HardwareSensorSource.h"
+#include "SensorFrames.h"
+
+#ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
+#define SDAPIN  20
+#define SCLPIN  21
+#define RSTPIN  7
+#else
+#define SDAPIN  A4
+#define SCLPIN  A5
+#define RSTPIN  2
+#endif
+
+HardwareSensorSource::HardwareSensorSource(bool multiplexerEnabled, uint8_t multiplexerAddress)
+        : multiplexerEnabled(multiplexerEnabled), multiplexer(multiplexerAddress) {
+}
+
+HardwareSensorSource::~HardwareSensorSource() {
+    if(multiplexerEnabled) {
+        for (int chan = 0; chan < 8; chan++) {
+            multiplexer.disableChannel(chan);
+            delay(100);
+        }
+    }
+
+    // Sensors are owned by unique_ptr inside the maps, so they are released
+    // automatically; no manual delete needed.
+}
+
+void HardwareSensorSource::addTemperatureHumiditySensor(const std::string &name, uint8_t channel, uint8_t address) {
+    temperatureHumiditySensors[name] = {std::unique_ptr<SHT35>(new SHT35(SCLPIN, address)), channel};
+}
+
+void HardwareSensorSource::addDustSensor(const std::string &name, uint8_t channel, uint8_t address) {
+    dustSensors[name] = {std::unique_ptr<HM330X>(new HM330X(address)), channel};
+}
+
+bool HardwareSensorSource::begin() {
+    return !multiplexerEnabled || multiplexer.begin();
+}
+
+int8_t HardwareSensorSource::initSensor(const std::string &name) {
+    int8_t result = ERROR_PARAM;
+
+    auto th = temperatureHumiditySensors.find(name);
+    if (th != temperatureHumiditySensors.end()) {
+        selectChannel(th->second.channel);
+        result = th->second.sensor->init();
+        disableChannel(th->second.channel);
+    }
+
+    auto dust = dustSensors.find(name);
+    if (dust != dustSensors.end()) {
+        selectChannel(dust->second.channel);
+        result = dust->second.sensor->init();
+        disableChannel(dust->second.channel);
+    }
+
+    return result;
+}
+
+bool HardwareSensorSource::ready(const std::string &name) {
+    return true;
+}
+
+int8_t HardwareSensorSource::readTemperatureHumidity(const std::string &name, float &celsius, float &humidity) {
+    auto it = temperatureHumiditySensors.find(name);
+    if (it == temperatureHumiditySensors.end()) {
+        return ERROR_PARAM;
+    }
+
+    selectChannel(it->second.channel);
+    err_t result = it->second.sensor->read_meas_data_single_shot(HIGH_REP_WITH_STRCH, &celsius, &humidity);
+    disableChannel(it->second.channel);
+    return result;
+}
+
+int8_t HardwareSensorSource::readDust(const std::string &name, uint8_t *frame) {
+    auto it = dustSensors.find(name);
+    if (it == dustSensors.end()) {
+        return ERROR_PARAM;
+    }
+
+    selectChannel(it->second.channel);
+    err_t result = it->second.sensor->read_sensor_value(frame, DUST_FRAME_LENGTH);
+    disableChannel(it->second.channel);
+    return result;
+}
+
+void HardwareSensorSource::selectChannel(uint8_t channel) {
+    if(multiplexerEnabled && channel != SENSOR_NO_CHANNEL) {
+        multiplexer.selectChannel(channel);
+    }
+}
+
+void HardwareSensorSource::disableChannel(uint8_t channel) {
+    if(multiplexerEnabled && channel != SENSOR_NO_CHANNEL) {
+        multiplexer.disableChannel(channel);
+    }
+}
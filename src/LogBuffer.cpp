@@ -0,0 +1,188 @@
+#include <cstring>
+#include <sstream>
+#include "LogBuffer.h"
+
+LogBuffer::LogBuffer(uint8_t maxNewPerWindow, unsigned long windowMs)
+        : records(), head(0), count(0), maxNewPerWindow(maxNewPerWindow), windowMs(windowMs), windowStart(0),
+          windowCount(0), dropped(0), droppedEpoch(0), droppedUptimeMs(0) {
+}
+
+LogRecord &LogBuffer::at(size_t index) {
+    return records[(head + index) % CAPACITY];
+}
+
+const LogRecord &LogBuffer::at(size_t index) const {
+    return records[(head + index) % CAPACITY];
+}
+
+size_t LogBuffer::size() const {
+    return count;
+}
+
+bool LogBuffer::empty() const {
+    return count == 0 && dropped == 0;
+}
+
+void LogBuffer::add(unsigned long epoch, unsigned long nowMs, uint8_t severityNumber, const char *message) {
+    // Fold repeats into the existing record; they do not count against the rate
+    // limit since they cost no extra space.
+    for (size_t i = 0; i < count; i++) {
+        LogRecord &r = at(i);
+        if (r.severityNumber == severityNumber && strncmp(r.message, message, LogRecord::MESSAGE_LENGTH - 1) == 0) {
+            if (r.count < UINT16_MAX) {
+                r.count++;
+            }
+            r.lastEpoch = epoch;
+            r.lastUptimeMs = nowMs;
+            return;
+        }
+    }
+
+    // Fixed-window rate limit on new records (unsigned subtraction is safe
+    // across the millis() rollover).
+    if (nowMs - windowStart >= windowMs) {
+        windowStart = nowMs;
+        windowCount = 0;
+    }
+    if (windowCount >= maxNewPerWindow) {
+        dropped++;
+        droppedEpoch = epoch;
+        droppedUptimeMs = nowMs;
+        return;
+    }
+    windowCount++;
+
+    // Overwrite the oldest record when full.
+    if (count == CAPACITY) {
+        head = (head + 1) % CAPACITY;
+        count--;
+        dropped++;
+        droppedEpoch = epoch;
+        droppedUptimeMs = nowMs;
+    }
+
+    LogRecord &r = at(count);
+    r.epoch = epoch;
+    r.lastEpoch = epoch;
+    r.uptimeMs = nowMs;
+    r.lastUptimeMs = nowMs;
+    r.count = 1;
+    r.severityNumber = severityNumber;
+    strncpy(r.message, message, LogRecord::MESSAGE_LENGTH - 1);
+    r.message[LogRecord::MESSAGE_LENGTH - 1] = '\0';
+    count++;
+}
+
+void LogBuffer::discard(size_t n) {
+    if (n > count) {
+        n = count;
+    }
+    head = (head + n) % CAPACITY;
+    count -= n;
+    dropped = 0;
+}
+
+// Appends `value` as the contents of a JSON string (quotes, backslashes and
+// control characters escaped).
+static void appendJsonString(std::stringstream &ss, const char *value) {
+    for (const char *c = value; *c != '\0'; c++) {
+        switch (*c) {
+            case '"':
+                ss << "\\\"";
+                break;
+            case '\\':
+                ss << "\\\\";
+                break;
+            case '\n':
+                ss << "\\n";
+                break;
+            case '\r':
+                ss << "\\r";
+                break;
+            case '\t':
+                ss << "\\t";
+                break;
+            default:
+                if ((unsigned char) *c < 0x20) {
+                    static const char hex[] = "0123456789abcdef";
+                    ss << "\\u00" << hex[*c >> 4] << hex[*c & 0x0F];
+                } else {
+                    ss << *c;
+                }
+        }
+    }
+}
+
+// Time of an event logged at `epoch`/`uptimeMs`, as of an export at
+// `nowEpoch`/`nowMs`; 0 if neither clock reading is usable.
+static unsigned long exportEpoch(unsigned long epoch, unsigned long uptimeMs, unsigned long nowEpoch,
+                                 unsigned long nowMs) {
+    if (rtcEpochValid(epoch)) {
+        return epoch;
+    }
+    if (!rtcEpochValid(nowEpoch)) {
+        return 0;
+    }
+    return nowEpoch - (nowMs - uptimeMs) / 1000;
+}
+
+// As with metric data points, a timestamp is the epoch in seconds with nine
+// zeros appended (64-bit fields are JSON strings); 0 means unknown.
+static void appendTimeUnixNano(std::stringstream &ss, unsigned long epoch) {
+    ss << "\"" << epoch;
+    if (epoch != 0) {
+        ss << "000000000";
+    }
+    ss << "\"";
+}
+
+// Appends one OTLP LogRecord, with the device uptime at the first occurrence
+// as an attribute (the only timing there is for a record with unknown time).
+static void appendLogRecord(std::stringstream &ss, bool &first, unsigned long epoch, unsigned long lastEpoch,
+                            unsigned long uptimeMs, uint8_t severityNumber, const char *message,
+                            uint32_t repeatCount) {
+    if (!first) {
+        ss << ",";
+    }
+    first = false;
+    ss << "{\"timeUnixNano\":";
+    appendTimeUnixNano(ss, epoch);
+    ss << ",\"observedTimeUnixNano\":";
+    appendTimeUnixNano(ss, lastEpoch);
+    ss << ",\"severityNumber\":" << (int) severityNumber << ","
+       << "\"severityText\":\"" << (severityNumber >= LOG_SEVERITY_ERROR ? "ERROR" : "WARN") << "\","
+       << "\"body\":{\"stringValue\":\"";
+    appendJsonString(ss, message);
+    ss << "\"},\"attributes\":["
+       << "{\"key\":\"log.repeat_count\",\"value\":{\"intValue\":\"" << repeatCount << "\"}},"
+       << "{\"key\":\"device.uptime_ms\",\"value\":{\"intValue\":\"" << uptimeMs << "\"}}]}";
+}
+
+std::string LogBuffer::toOtlpJson(const char *serviceName, size_t n, unsigned long epoch, unsigned long nowMs) const {
+    if (n > count) {
+        n = count;
+    }
+
+    std::stringstream ss;
+    ss << "{\"resourceLogs\":[{"
+       << "\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":{\"stringValue\":\""
+       << serviceName << "\"}}]},"
+       << "\"scopeLogs\":[{\"scope\":{\"name\":\"" << serviceName << "\"},\"logRecords\":[";
+
+    bool first = true;
+    for (size_t i = 0; i < n; i++) {
+        const LogRecord &r = at(i);
+        appendLogRecord(ss, first, exportEpoch(r.epoch, r.uptimeMs, epoch, nowMs),
+                        exportEpoch(r.lastEpoch, r.lastUptimeMs, epoch, nowMs), r.uptimeMs, r.severityNumber,
+                        r.message, r.count);
+    }
+    if (dropped > 0) {
+        std::stringstream message;
+        message << dropped << " log records dropped (rate limit or buffer full)";
+        unsigned long time = exportEpoch(droppedEpoch, droppedUptimeMs, epoch, nowMs);
+        appendLogRecord(ss, first, time, time, droppedUptimeMs, LOG_SEVERITY_WARN, message.str().c_str(), 1);
+    }
+
+    ss << "]}]}]}";
+    return ss.str();
+}
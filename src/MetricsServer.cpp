@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <cstring>
+#include "MetricsServer.h"
+
+MetricsServer::MetricsServer(MetricsListener &listener, const MetricsSnapshot &snapshot)
+        : listener(listener), snapshot(snapshot), started(false), client(nullptr), requestLength(0),
+          requestStarted(0) {
+}
+
+void MetricsServer::begin() {
+    listener.begin();
+    started = true;
+}
+
+void MetricsServer::poll() {
+    if (!started) {
+        return;
+    }
+
+    if (client == nullptr) {
+        client = listener.accept();
+        if (client == nullptr) {
+            return;
+        }
+        requestLength = 0;
+        requestStarted = millis();
+    }
+
+    // Consume only what has already arrived, up to the end of the request
+    // line ("GET /metrics HTTP/1.1"); the headers are irrelevant.
+    bool complete = false;
+    for (int pending = client->available(); pending > 0 && !complete; pending--) {
+        char c = client->read();
+        if (c == '\n') {
+            complete = true;
+        } else if (requestLength < sizeof(requestLine) - 1) {
+            requestLine[requestLength++] = c;
+        }
+    }
+
+    if (!complete) {
+        if (!client->connected() || millis() - requestStarted >= REQUEST_TIMEOUT_MS) {
+            client->stop();
+            client = nullptr;
+        }
+        return;
+    }
+
+    requestLine[requestLength] = '\0';
+    while (client->available()) {
+        client->read();
+    }
+
+    if (strncmp(requestLine, "GET /metrics ", 13) == 0 || strcmp(requestLine, "GET /metrics\r") == 0) {
+        // Copy out of whichever buffer is current right now; a publish during
+        // the write goes to the other buffer.
+        respond("200 OK", snapshot.current());
+    } else {
+        respond("404 Not Found", "Not Found\n");
+    }
+
+    client->stop();
+    client = nullptr;
+}
+
+void MetricsServer::respond(const char *status, const std::string &body) {
+    uint8_t chunk[RESPONSE_CHUNK];
+    int headerLength = snprintf((char *) chunk, sizeof(chunk),
+                                "HTTP/1.1 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                                "Content-Length: %u\r\nConnection: close\r\n\r\n",
+                                status, (unsigned) body.length());
+    size_t length = headerLength > 0 ? (size_t) headerLength : 0;
+    size_t offset = 0;
+    unsigned long started = millis();
+
+    do {
+        size_t n = body.length() - offset < sizeof(chunk) - length ? body.length() - offset : sizeof(chunk) - length;
+        memcpy(chunk + length, body.data() + offset, n);
+        length += n;
+        offset += n;
+
+        if (client->write(chunk, length) != length || millis() - started >= RESPONSE_TIMEOUT_MS) {
+            // The caller stops the client; a client that is not keeping up
+            // simply gets a truncated response.
+            return;
+        }
+        length = 0;
+    } while (offset < body.length());
+}
@@ -0,0 +1,80 @@
+#include <cstring>
+#include <sstream>
+#include "MetricsSnapshot.h"
+
+MetricsSnapshot::MetricsSnapshot()
+        : buffers(), front(0), published(0) {
+}
+
+const std::string &MetricsSnapshot::current() const {
+    return buffers[front];
+}
+
+uint32_t MetricsSnapshot::generation() const {
+    return published;
+}
+
+void MetricsSnapshot::publish(const std::vector<MetricPoint> &points) {
+    uint8_t back = front ^ 1;
+    buffers[back] = render(points);
+    front = back;
+    published++;
+}
+
+// Metric names become Prometheus names the same way the Collector maps them:
+// anything outside [a-zA-Z0-9_:] (the dots) becomes an underscore.
+static void appendMetricName(std::stringstream &ss, const char *metric) {
+    for (const char *c = metric; *c != '\0'; c++) {
+        bool valid = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9') ||
+                     *c == '_' || *c == ':';
+        ss << (valid ? *c : '_');
+    }
+}
+
+// Label values escape backslash, double quote and newline.
+static void appendLabelValue(std::stringstream &ss, const char *value) {
+    for (const char *c = value; *c != '\0'; c++) {
+        if (*c == '\\' || *c == '"') {
+            ss << '\\' << *c;
+        } else if (*c == '\n') {
+            ss << "\\n";
+        } else {
+            ss << *c;
+        }
+    }
+}
+
+std::string MetricsSnapshot::render(const std::vector<MetricPoint> &points) {
+    std::stringstream ss;
+
+    // The exposition format wants all samples of a metric in one group under
+    // its TYPE line; group by name in order of first appearance, as the OTLP
+    // exporter does.
+    for (size_t i = 0; i < points.size(); i++) {
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; j++) {
+            seen = strcmp(points[j].metric, points[i].metric) == 0;
+        }
+        if (seen) {
+            continue;
+        }
+
+        ss << "# TYPE ";
+        appendMetricName(ss, points[i].metric);
+        ss << " gauge\n";
+
+        for (size_t j = i; j < points.size(); j++) {
+            if (strcmp(points[j].metric, points[i].metric) != 0) {
+                continue;
+            }
+            appendMetricName(ss, points[j].metric);
+            ss << "{sensor_name=\"";
+            appendLabelValue(ss, points[j].sensorName);
+            ss << "\",location=\"";
+            appendLabelValue(ss, points[j].location);
+            ss << "\"} " << points[j].value << "\n";
+        }
+    }
+
+    return ss.str();
+}
@@ -0,0 +1,152 @@
+#include <cstring>
+#include <sstream>
+#include "OtlpHttpExporter.h"
+
+OtlpHttpExporter::OtlpHttpExporter(Client &client, SerialLogger &logger, const char *host, int port,
+                                   const char *metricsPath, const char *serviceName, uint32_t responseTimeoutMs)
+        : client(client), logger(logger), host(host), port(port), metricsPath(metricsPath),
+          serviceName(serviceName), responseTimeoutMs(responseTimeoutMs), logBuffer(nullptr), logsPath(nullptr) {
+}
+
+void OtlpHttpExporter::setLogBuffer(LogBuffer *buffer, const char *logsPath) {
+    this->logBuffer = buffer;
+    this->logsPath = logsPath;
+}
+
+// Appends one OTLP NumberDataPoint (gauge, asDouble) with sensor.name + location
+// attributes to a per-metric data-point buffer. `first` tracks the comma between
+// data points. Values are formatted via stringstream (reliable float formatting
+// on SAMD, unlike snprintf("%f") which needs float printf support linked in).
+static void appendDataPoint(std::stringstream& dps, bool& first, const MetricPoint& point) {
+    if (!first) {
+        dps << ",";
+    }
+    first = false;
+    // timeUnixNano = epoch seconds * 1e9, built as a string (OTLP/JSON requires
+    // 64-bit fields as strings) by appending nine zeros — no 64-bit math needed.
+    dps << "{\"asDouble\":" << point.value
+        << ",\"timeUnixNano\":\"" << point.epoch << "000000000\","
+        << "\"attributes\":["
+        << "{\"key\":\"sensor.name\",\"value\":{\"stringValue\":\"" << point.sensorName << "\"}},"
+        << "{\"key\":\"location\",\"value\":{\"stringValue\":\"" << point.location << "\"}}"
+        << "]}";
+}
+
+// Appends one gauge metric to the metrics array (skipped if it has no data
+// points, e.g. no sensors of that kind are configured).
+static void appendGauge(std::stringstream& ss, bool& first, const char* name, const std::string& dataPoints) {
+    if (dataPoints.empty()) {
+        return;
+    }
+    if (!first) {
+        ss << ",";
+    }
+    first = false;
+    ss << "{\"name\":\"" << name << "\",\"gauge\":{\"dataPoints\":[" << dataPoints << "]}}";
+}
+
+std::string OtlpHttpExporter::serializeMetrics(const std::vector<MetricPoint> &points) const {
+    // Assemble the OTLP/HTTP JSON ExportMetricsServiceRequest. service.name maps
+    // to the Prometheus `job` label; metric-name dots become underscores.
+    std::stringstream ss;
+    ss << "{\"resourceMetrics\":[{"
+       << "\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":{\"stringValue\":\""
+       << serviceName << "\"}}]},"
+       << "\"scopeMetrics\":[{\"scope\":{\"name\":\"" << serviceName << "\"},\"metrics\":[";
+
+    // Emit one gauge per distinct metric name (in order of first appearance),
+    // grouping all of its data points — this keeps the OTLP payload compact. A
+    // batch only holds a handful of metrics, so the nested scan is cheap.
+    bool metricFirst = true;
+    for (size_t i = 0; i < points.size(); i++) {
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; j++) {
+            seen = strcmp(points[j].metric, points[i].metric) == 0;
+        }
+        if (seen) {
+            continue;
+        }
+
+        std::stringstream dps;
+        bool dpFirst = true;
+        for (size_t j = i; j < points.size(); j++) {
+            if (strcmp(points[j].metric, points[i].metric) == 0) {
+                appendDataPoint(dps, dpFirst, points[j]);
+            }
+        }
+        appendGauge(ss, metricFirst, points[i].metric, dps.str());
+    }
+
+    ss << "]}]}]}";
+    return ss.str();
+}
+
+int OtlpHttpExporter::post(HttpClient &httpClient, const char *path, const std::string &body) {
+    logger.Debug("Posting OTLP to http://%s:%d%s", host, port, path);
+    //logger.Debug("Payload %s", body.c_str());
+    httpClient.beginRequest();
+    httpClient.post(path);
+    httpClient.sendHeader("Content-Type", "application/json");
+    httpClient.sendHeader(HTTP_HEADER_CONTENT_LENGTH, body.length());
+    httpClient.beginBody();
+    httpClient.write((const uint8_t *)body.c_str(), body.length());
+
+    // Read the status code exactly once.
+    int statusCode = httpClient.responseStatusCode();
+
+    // Always drain the response body so no bytes are left pending in the WiFi
+    // receive buffer (and so a follow-up request on the kept-alive connection
+    // starts clean); only log it on a non-2xx status. Pass it as a "%s" argument
+    // (not as the format string) so a body containing '%' is safe. A successful
+    // OTLP/HTTP export returns 200 with an empty or {"partialSuccess":{}} body.
+    String responseBody = httpClient.responseBody();
+    if(statusCode >= 300) {
+        logger.Error("%s", responseBody.c_str());
+    }
+
+    return statusCode;
+}
+
+bool OtlpHttpExporter::accepted(int statusCode) const {
+    return statusCode >= 200 && statusCode < 300;
+}
+
+int OtlpHttpExporter::exportMetrics(const std::vector<MetricPoint> &points) {
+    // Plain HTTP to the LAN OpenTelemetry Collector; it converts to protobuf and
+    // forwards to Grafana Cloud, so the device needs no TLS or credentials here.
+    HttpClient httpClient(client, host, port);
+    // Bound the response wait below the watchdog window so a stalled collector
+    // returns an error here instead of tripping a watchdog reset.
+    httpClient.setHttpResponseTimeout(responseTimeoutMs);
+    // Keep the socket open between the metrics and logs requests.
+    httpClient.connectionKeepAlive();
+
+    unsigned long started = millis();
+    int statusCode = post(httpClient, metricsPath, serializeMetrics(points));
+
+    // Both requests share one response-timeout budget, so a slow Collector
+    // cannot keep a publish busy for twice the timeout (the watchdog is only
+    // fed before it). Logs get whatever the metrics post left over, and wait
+    // for the next publish if that is too little.
+    unsigned long elapsed = millis() - started;
+    uint32_t remaining = elapsed < responseTimeoutMs ? responseTimeoutMs - elapsed : 0;
+
+    // Logs only ride on a connection the Collector just accepted. Snapshot the
+    // record count first: records logged while posting (e.g. a failed logs
+    // export) stay buffered for the next cycle.
+    if (logBuffer != nullptr && !logBuffer->empty() && accepted(statusCode) && remaining >= MIN_LOGS_BUDGET_MS) {
+        httpClient.setHttpResponseTimeout(remaining);
+        size_t pending = logBuffer->size();
+        int logsStatusCode = post(httpClient, logsPath,
+                                  logBuffer->toOtlpJson(serviceName, pending, rtc.getEpoch(), millis()));
+        if (accepted(logsStatusCode)) {
+            logBuffer->discard(pending);
+        }
+    }
+
+    // Release the connection so socket buffers do not accumulate between
+    // publish cycles.
+    httpClient.stop();
+
+    return statusCode;
+}
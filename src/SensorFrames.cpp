@@ -0,0 +1,53 @@
+#include "SensorFrames.h"
+
+bool decodeDustFrame(const uint8_t *frame, DustReading &reading) {
+    // Get checksum from sensor read
+    uint8_t sum = 0;
+    for (int i = 0; i < DUST_FRAME_LENGTH - 1; i++) {
+        sum += frame[i];
+    }
+
+    if (sum != frame[DUST_FRAME_LENGTH - 1]) {
+        return false;
+    }
+
+    // Parse sensor values out
+    reading.pm1_0_spm = (uint16_t) frame[2 * 2] << 8 | frame[2 * 2 + 1];
+    reading.pm2_5_spm = (uint16_t) frame[3 * 2] << 8 | frame[3 * 2 + 1];
+    reading.pm10_spm = (uint16_t) frame[4 * 2] << 8 | frame[4 * 2 + 1];
+    reading.pm1_0_ae = (uint16_t) frame[5 * 2] << 8 | frame[5 * 2 + 1];
+    reading.pm2_5_ae = (uint16_t) frame[6 * 2] << 8 | frame[6 * 2 + 1];
+    reading.pm10_ae = (uint16_t) frame[7 * 2] << 8 | frame[7 * 2 + 1];
+    return true;
+}
+
+float shtTemperatureFromRaw(uint16_t raw) {
+    return (raw / 65535.00) * 175 - 45;
+}
+
+float shtHumidityFromRaw(uint16_t raw) {
+    return (raw / 65535.0) * 100.0;
+}
+
+// Rounds to the nearest raw word, clamped to the 16-bit range.
+static uint16_t toRawWord(double scaled) {
+    if (scaled <= 0) {
+        return 0;
+    }
+    if (scaled >= 65535) {
+        return 65535;
+    }
+    return (uint16_t) (scaled + 0.5);
+}
+
+uint16_t shtRawFromTemperature(float celsius) {
+    return toRawWord((celsius + 45) / 175.0 * 65535.0);
+}
+
+uint16_t shtRawFromHumidity(float humidity) {
+    return toRawWord(humidity / 100.0 * 65535.0);
+}
+
+float fahrenheitFromCelsius(float celsius) {
+    return (celsius * 1.8) + 32;
+}
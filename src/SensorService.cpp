@@ -1,17 +1,7 @@
-#include <sstream>
+#include <cstring>
 //#include <format>
 #include "SensorService.h"
 
-#ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
-#define SDAPIN  20
-#define SCLPIN  21
-#define RSTPIN  7
-#else
-#define SDAPIN  A4
-#define SCLPIN  A5
-#define RSTPIN  2
-#endif
-
 // const char* str[] = {"sensor num: %d",
 //                      "PM1.0 concentration(CF=1,Standard particulate matter,unit:ug/m3): %d",
 //                      "PM2.5 concentration(CF=1,Standard particulate matter,unit:ug/m3): %d",
@@ -22,86 +12,148 @@
 //                     };
 
 TempHumditySensor::TempHumditySensor()
-    : sensor(nullptr), usesMultiplexer(false), multiplierChannel(0), location() {
+    : usesMultiplexer(false), multiplierChannel(0), location(), samplingPeriodMs(0), nextSampleMs(0) {
 }
 
-TempHumditySensor::TempHumditySensor(std::unique_ptr<SHT35> sensor, std::string location)
-    : sensor(std::move(sensor)), usesMultiplexer(false), multiplierChannel(0), location(std::move(location)) {
+TempHumditySensor::TempHumditySensor(std::string location)
+    : usesMultiplexer(false), multiplierChannel(0), location(std::move(location)), samplingPeriodMs(0),
+      nextSampleMs(0) {
 }
 
-TempHumditySensor::TempHumditySensor(std::unique_ptr<SHT35> sensor, ushort channel, std::string location)
-    : sensor(std::move(sensor)), usesMultiplexer(true), multiplierChannel(channel), location(std::move(location)) {
+TempHumditySensor::TempHumditySensor(ushort channel, std::string location)
+    : usesMultiplexer(true), multiplierChannel(channel), location(std::move(location)), samplingPeriodMs(0),
+      nextSampleMs(0) {
 }
 
 DustSensor::DustSensor()
-        : sensor(nullptr), usesMultiplexer(false), multiplierChannel(0), location() {
+        : usesMultiplexer(false), multiplierChannel(0), location(), samplingPeriodMs(0), nextSampleMs(0) {
+}
+
+DustSensor::DustSensor(std::string location)
+        : usesMultiplexer(false), multiplierChannel(0), location(std::move(location)), samplingPeriodMs(0),
+          nextSampleMs(0) {
+}
+
+DustSensor::DustSensor(ushort channel, std::string location)
+        : usesMultiplexer(true), multiplierChannel(channel), location(std::move(location)), samplingPeriodMs(0),
+          nextSampleMs(0) {
 }
 
-DustSensor::DustSensor(std::unique_ptr<HM330X> sensor, std::string location)
-        : sensor(std::move(sensor)), usesMultiplexer(false), multiplierChannel(0), location(std::move(location)) {
+SensorService::SensorService(SerialLogger &logger, SensorSource &source)
+        : source(source), logger(logger), traceWriter(nullptr), metricsSnapshot(nullptr) {
 }
 
-DustSensor::DustSensor(std::unique_ptr<HM330X> sensor, ushort channel, std::string location)
-        : sensor(std::move(sensor)), usesMultiplexer(true), multiplierChannel(channel), location(std::move(location)) {
+void SensorService::setTraceWriter(SensorTraceWriter *writer) {
+    traceWriter = writer;
 }
 
-SensorService::SensorService(SerialLogger &logger, bool multiplexerEnabled, uint8_t multiplexerAddress)
-        : logger(logger), multiplexerEnabled(multiplexerEnabled), multiplexer(multiplexerAddress) {
+void SensorService::setMetricsSnapshot(MetricsSnapshot *snapshot) {
+    metricsSnapshot = snapshot;
 }
 
-// Appends one OTLP NumberDataPoint (gauge, asDouble) with sensor.name + location
-// attributes to a per-metric data-point buffer. `first` tracks the comma between
-// data points. Values are formatted via stringstream (reliable float formatting
-// on SAMD, unlike snprintf("%f") which needs float printf support linked in).
-static void appendDataPoint(std::stringstream& dps, bool& first, double value, unsigned long epoch,
-                            const char* name, const char* location) {
-    if (!first) {
-        dps << ",";
+// Sets the period of the sensors of one type, the first due at `firstMs` and
+// each following one `stepMs` later.
+template<typename Sensors>
+static void scheduleSensors(Sensors &sensors, unsigned long periodMs, unsigned long firstMs, unsigned long stepMs) {
+    size_t index = 0;
+    for (auto &sensor: sensors) {
+        sensor.second.samplingPeriodMs = periodMs;
+        sensor.second.nextSampleMs = firstMs + stepMs * index;
+        index++;
     }
-    first = false;
-    // timeUnixNano = epoch seconds * 1e9, built as a string (OTLP/JSON requires
-    // 64-bit fields as strings) by appending nine zeros — no 64-bit math needed.
-    dps << "{\"asDouble\":" << value
-        << ",\"timeUnixNano\":\"" << epoch << "000000000\","
-        << "\"attributes\":["
-        << "{\"key\":\"sensor.name\",\"value\":{\"stringValue\":\"" << name << "\"}},"
-        << "{\"key\":\"location\",\"value\":{\"stringValue\":\"" << location << "\"}}"
-        << "]}";
 }
 
-// Appends one gauge metric to the metrics array (skipped if it has no data
-// points, e.g. no sensors of that kind are configured).
-static void appendGauge(std::stringstream& ss, bool& first, const char* name, const std::string& dataPoints) {
-    if (dataPoints.empty()) {
-        return;
+void SensorService::setSamplingPeriods(unsigned long temperatureHumidityPeriodMs, unsigned long dustPeriodMs) {
+    setSamplingPeriods(temperatureHumidityPeriodMs, dustPeriodMs, millis());
+}
+
+void SensorService::setSamplingPeriods(unsigned long temperatureHumidityPeriodMs, unsigned long dustPeriodMs,
+                                       unsigned long now) {
+    unsigned long dustStep = dustSensors.empty() ? 0 : dustPeriodMs / dustSensors.size();
+    unsigned long temperatureHumidityStep =
+            temperatureHumiditySensors.empty() ? 0 : temperatureHumidityPeriodMs / temperatureHumiditySensors.size();
+    if (dustStep > 0 && temperatureHumidityStep >= dustStep) {
+        temperatureHumidityStep -= temperatureHumidityStep % dustStep;
     }
-    if (!first) {
-        ss << ",";
+
+    // The first temperature/humidity read is half a dust interval in and the
+    // first dust read a whole one, so the first tick does not take both.
+    scheduleSensors(dustSensors, dustPeriodMs, now + dustStep, dustStep);
+    scheduleSensors(temperatureHumiditySensors, temperatureHumidityPeriodMs, now + dustStep / 2,
+                    temperatureHumidityStep);
+}
+
+// Returns whether a sensor is due at `now` and, if so, schedules its next
+// sample. The signed difference keeps this correct across the millis()
+// rollover; a sensor that fell more than a period behind (e.g. during a slow
+// publish) restarts from now rather than reading repeatedly to catch up.
+static bool takeIfDue(unsigned long &nextSampleMs, unsigned long periodMs, unsigned long now) {
+    if ((long) (now - nextSampleMs) < 0) {
+        return false;
     }
-    first = false;
-    ss << "{\"name\":\"" << name << "\",\"gauge\":{\"dataPoints\":[" << dataPoints << "]}}";
+    nextSampleMs += periodMs;
+    if ((long) (now - nextSampleMs) >= 0) {
+        nextSampleMs = now + periodMs;
+    }
+    return true;
 }
 
-int SensorService::readAndPublishSensors(int(*publish)(const std::string& str), const char* serviceName) {
-    // One timestamp for the whole batch, so all points share a consistent time.
-    const unsigned long epoch = rtc.getEpoch();
+void SensorService::addSample(const MetricPoint &point) {
+    // Readings taken before the first NTP sync still update the local snapshot
+    // but are not queued for export.
+    if (rtcEpochValid(point.epoch)) {
+        if (pendingPoints.size() >= MAX_PENDING_POINTS) {
+            pendingPoints.erase(pendingPoints.begin());
+        }
+        pendingPoints.push_back(point);
+    }
 
-    // Accumulate data points per metric across all sensors, then emit one gauge
-    // metric per measurement (grouping keeps the OTLP payload compact).
-    std::stringstream temperatureDps, humidityDps, pm1_0Dps, pm2_5Dps, pm10Dps;
-    bool temperatureFirst = true, humidityFirst = true, pm1_0First = true, pm2_5First = true, pm10First = true;
+    // Sensor names point into the sensor maps, so the same series always has
+    // the same pointer; metric names are string literals, compared by value.
+    for (auto &latest: latestPoints) {
+        if (latest.sensorName == point.sensorName && strcmp(latest.metric, point.metric) == 0) {
+            latest = point;
+            return;
+        }
+    }
+    latestPoints.push_back(point);
+}
+
+int SensorService::sampleSensors() {
+    // One timestamp for the whole tick, so all points read together share it.
+    return sampleSensors(millis(), rtc.getEpoch());
+}
+
+int SensorService::sampleSensors(unsigned long now, unsigned long epoch) {
+    int sampled = 0;
+
+    for (auto &tempSensor: temperatureHumiditySensors) {
+        if (!source.ready(tempSensor.first) ||
+            !takeIfDue(tempSensor.second.nextSampleMs, tempSensor.second.samplingPeriodMs, now)) {
+            continue;
+        }
+        if (sampled++ == 0 && traceWriter != nullptr) {
+            traceWriter->cycle(epoch, now);
+        }
 
-    for (const auto &tempSensor: temperatureHumiditySensors) {
         auto[temperature, humidity] = readTemperatureHumiditySensor(tempSensor.first);
         logger.Debug("%s - Temperature: %.2f, Humidity: %.2f%%", tempSensor.first.c_str(), temperature, humidity);
 
         const char* name = tempSensor.first.c_str();
         const char* location = tempSensor.second.location.c_str();
-        appendDataPoint(temperatureDps, temperatureFirst, temperature, epoch, name, location);
-        appendDataPoint(humidityDps, humidityFirst, humidity, epoch, name, location);
+        addSample({"environment.temperature_fahrenheit", temperature, epoch, name, location});
+        addSample({"environment.humidity_percent", humidity, epoch, name, location});
     }
 
-    for (const auto &dustSensor: dustSensors) {
+    for (auto &dustSensor: dustSensors) {
+        if (!source.ready(dustSensor.first) ||
+            !takeIfDue(dustSensor.second.nextSampleMs, dustSensor.second.samplingPeriodMs, now)) {
+            continue;
+        }
+        if (sampled++ == 0 && traceWriter != nullptr) {
+            traceWriter->cycle(epoch, now);
+        }
+
         auto[pm1_0_spm, pm2_5_spm, pm10_spm, pm1_0_ae, pm2_5_ae, pm10_ae] = readDustSensor(dustSensor.first);
         logger.Debug("%s - PM1.0 concentration(Atmospheric environment,unit:ug/m3): %d", dustSensor.first.c_str(),
                      pm1_0_ae);
@@ -112,32 +164,41 @@ int SensorService::readAndPublishSensors(int(*publish)(const std::string& str),
 
         const char* name = dustSensor.first.c_str();
         const char* location = dustSensor.second.location.c_str();
-        appendDataPoint(pm1_0Dps, pm1_0First, pm1_0_ae, epoch, name, location);
-        appendDataPoint(pm2_5Dps, pm2_5First, pm2_5_ae, epoch, name, location);
-        appendDataPoint(pm10Dps, pm10First, pm10_ae, epoch, name, location);
+        addSample({"environment.pm1_0_ugm3", (double) pm1_0_ae, epoch, name, location});
+        addSample({"environment.pm2_5_ugm3", (double) pm2_5_ae, epoch, name, location});
+        addSample({"environment.pm10_ugm3", (double) pm10_ae, epoch, name, location});
     }
 
-    // Assemble the OTLP/HTTP JSON ExportMetricsServiceRequest. service.name maps
-    // to the Prometheus `job` label; metric-name dots become underscores.
-    std::stringstream ss;
-    ss << "{\"resourceMetrics\":[{"
-       << "\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":{\"stringValue\":\""
-       << serviceName << "\"}}]},"
-       << "\"scopeMetrics\":[{\"scope\":{\"name\":\"" << serviceName << "\"},\"metrics\":[";
-
-    bool metricFirst = true;
-    appendGauge(ss, metricFirst, "environment.temperature_fahrenheit", temperatureDps.str());
-    appendGauge(ss, metricFirst, "environment.humidity_percent", humidityDps.str());
-    appendGauge(ss, metricFirst, "environment.pm1_0_ugm3", pm1_0Dps.str());
-    appendGauge(ss, metricFirst, "environment.pm2_5_ugm3", pm2_5Dps.str());
-    appendGauge(ss, metricFirst, "environment.pm10_ugm3", pm10Dps.str());
-
-    ss << "]}]}]}";
-
-    // Bind the payload to a const local so it is passed to the callback by
-    // reference (see publish signature) rather than copied by value.
-    const std::string payload = ss.str();
-    return publish(payload);
+    // Refresh the local scrape snapshot on every tick that read something, so
+    // it reflects the newest reading of each sensor even if the network is down.
+    if (sampled > 0 && metricsSnapshot != nullptr) {
+        metricsSnapshot->publish(latestPoints);
+    }
+
+    return sampled;
+}
+
+int SensorService::publishSamples(MetricExporter &exporter) {
+    if (pendingPoints.empty()) {
+        return 0;
+    }
+
+    // One bounded batch per publish keeps both the request the exporter
+    // builds and the time spent on the network (the watchdog window) the same
+    // however long the backlog is. The exporter decides how to group and
+    // encode the points on the wire.
+    size_t count = pendingPoints.size() < MAX_POINTS_PER_EXPORT ? pendingPoints.size() : MAX_POINTS_PER_EXPORT;
+    std::vector<MetricPoint> batch(pendingPoints.begin(), pendingPoints.begin() + count);
+
+    int statusCode = exporter.exportMetrics(batch);
+    if (exporter.accepted(statusCode)) {
+        pendingPoints.erase(pendingPoints.begin(), pendingPoints.begin() + count);
+    }
+    return statusCode;
+}
+
+size_t SensorService::pendingSamples() const {
+    return pendingPoints.size();
 }
 
 std::tuple<float, float> SensorService::readTemperatureHumiditySensor(const std::string& name) {
@@ -151,23 +212,20 @@ std::tuple<float, float> SensorService::readTemperatureHumiditySensor(const std:
     }
     auto& s = it->second;
 
-    if(multiplexerEnabled && s.usesMultiplexer) {
-        //logger.Debug("Selecting multiplexer channel: %d", s.multiplierChannel);
-        multiplexer.selectChannel(s.multiplierChannel);
+    unsigned long started = micros();
+    int8_t result = source.readTemperatureHumidity(name, temperature, humidity);
+    if (traceWriter != nullptr) {
+        // The driver only exposes floats; recover the raw words from them
+        // (exact at 16-bit resolution, see SensorFrames.h).
+        traceWriter->temperatureHumidity(name, s.usesMultiplexer ? s.multiplierChannel : TRACE_NO_CHANNEL, result,
+                                         micros() - started, shtRawFromTemperature(temperature),
+                                         shtRawFromHumidity(humidity));
     }
-
-    if (s.sensor != nullptr &&
-        NO_ERROR !=
-        s.sensor->read_meas_data_single_shot(HIGH_REP_WITH_STRCH, &temperature, &humidity)) {
+    if (SENSOR_OK != result) {
         logger.Warning("Read failed for sensor %s", name.c_str());
     }
 
-    temperature = (temperature * 1.8) + 32;
-
-    if(multiplexerEnabled && s.usesMultiplexer) {
-        //logger.Debug("Disabling multiplexer channel: %d", s.multiplierChannel);
-        multiplexer.disableChannel(s.multiplierChannel);
-    }
+    temperature = fahrenheitFromCelsius(temperature);
 
     return {temperature, humidity};
 }
@@ -187,44 +245,27 @@ std::tuple<uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t> SensorSer
     }
     auto& s = it->second;
 
-    if(multiplexerEnabled && s.usesMultiplexer) {
-        //logger.Debug("Selecting multiplexer channel: %d", s.multiplierChannel);
-        multiplexer.selectChannel(s.multiplierChannel);
+    unsigned long started = micros();
+    int8_t result = source.readDust(name, dustSensorBuffer);
+    if (traceWriter != nullptr) {
+        traceWriter->dust(name, s.usesMultiplexer ? s.multiplierChannel : TRACE_NO_CHANNEL, result,
+                          micros() - started, dustSensorBuffer);
     }
 
-    if (s.sensor != nullptr &&
-        NO_ERROR == s.sensor->read_sensor_value(dustSensorBuffer, 29)) {
-        // Get checksum from sensor read
-        uint8_t sum = 0;
-        for (int i = 0; i < 28; i++) {
-            sum += dustSensorBuffer[i];
-        }
-
-        if (sum == dustSensorBuffer[28]) {
-            // Parse sensor values out
-            pm1_0_spm = (uint16_t) dustSensorBuffer[2 * 2] << 8 | dustSensorBuffer[2 * 2 + 1];
-            pm2_5_spm = (uint16_t) dustSensorBuffer[3 * 2] << 8 | dustSensorBuffer[3 * 2 + 1];
-            pm10_spm = (uint16_t) dustSensorBuffer[4 * 2] << 8 | dustSensorBuffer[4 * 2 + 1];
-            pm1_0_ae = (uint16_t) dustSensorBuffer[5 * 2] << 8 | dustSensorBuffer[5 * 2 + 1];
-            pm2_5_ae = (uint16_t) dustSensorBuffer[6 * 2] << 8 | dustSensorBuffer[6 * 2 + 1];
-            pm10_ae = (uint16_t) dustSensorBuffer[7 * 2] << 8 | dustSensorBuffer[7 * 2 + 1];
-
-            // uint16_t value = 0;
-            // for (int i = 2; i < 8; i++) {
-            //     value = (uint16_t) dustSensorBuffer[i * 2] << 8 | dustSensorBuffer[i * 2 + 1];
-            //     logger.Debug(str[i - 1], value);
-            // }
-        } else {
-            logger.Error("Checksum for sensor %s failed", name.c_str());
-        }
-    } else {
+    DustReading reading;
+    if (SENSOR_OK != result) {
         logger.Warning("Read failed for sensor %s", name.c_str());
+    } else if (decodeDustFrame(dustSensorBuffer, reading)) {
+        pm1_0_spm = reading.pm1_0_spm;
+        pm2_5_spm = reading.pm2_5_spm;
+        pm10_spm = reading.pm10_spm;
+        pm1_0_ae = reading.pm1_0_ae;
+        pm2_5_ae = reading.pm2_5_ae;
+        pm10_ae = reading.pm10_ae;
+    } else {
+        logger.Error("Checksum for sensor %s failed", name.c_str());
     }
 
-    if(multiplexerEnabled && s.usesMultiplexer) {
-        //logger.Debug("Disabling multiplexer channel: %d", s.multiplierChannel);
-        multiplexer.disableChannel(s.multiplierChannel);
-    }
 /*  The standard particulate matter mass concentration value refers to the mass concentration value obtained by 
     density conversion of industrial metal particles as equivalent particles, and is suitable for use in industrial 
     production workshops and the like.
@@ -237,89 +278,50 @@ std::tuple<uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t> SensorSer
 }
 
 SensorService *SensorService::addTemperatureHumiditySensor(std::string name, std::string location, uint8_t IIC_ADDR) {
-    // The struct owns its sensor via unique_ptr and is move-only, so emplace it.
-    temperatureHumiditySensors.emplace(
-        std::move(name),
-        TempHumditySensor(std::unique_ptr<SHT35>(new SHT35(SCLPIN, IIC_ADDR)), std::move(location)));
+    source.addTemperatureHumiditySensor(name, SENSOR_NO_CHANNEL, IIC_ADDR);
+    temperatureHumiditySensors.emplace(std::move(name), TempHumditySensor(std::move(location)));
     return this;
 }
 
 SensorService *SensorService::addTemperatureHumiditySensor(std::string name, std::string location, ushort channel, uint8_t IIC_ADDR) {
-    temperatureHumiditySensors.emplace(
-        std::move(name),
-        TempHumditySensor(std::unique_ptr<SHT35>(new SHT35(SCLPIN, IIC_ADDR)), channel, std::move(location)));
+    source.addTemperatureHumiditySensor(name, channel, IIC_ADDR);
+    temperatureHumiditySensors.emplace(std::move(name), TempHumditySensor(channel, std::move(location)));
     return this;
 }
 
 SensorService *SensorService::addDustSensor(std::string name, std::string location, uint8_t IIC_ADDR) {
-    dustSensors.emplace(
-        std::move(name),
-        DustSensor(std::unique_ptr<HM330X>(new HM330X(IIC_ADDR)), std::move(location)));
+    source.addDustSensor(name, SENSOR_NO_CHANNEL, IIC_ADDR);
+    dustSensors.emplace(std::move(name), DustSensor(std::move(location)));
     return this;
 }
 
 SensorService *SensorService::addDustSensor(std::string name, std::string location, ushort channel, uint8_t IIC_ADDR) {
-    dustSensors.emplace(
-        std::move(name),
-        DustSensor(std::unique_ptr<HM330X>(new HM330X(IIC_ADDR)), channel, std::move(location)));
+    source.addDustSensor(name, channel, IIC_ADDR);
+    dustSensors.emplace(std::move(name), DustSensor(channel, std::move(location)));
     return this;
 }
 
 bool SensorService::InitializeSensors() {
     bool isSuccessful = true;
 
-    if(multiplexerEnabled && !multiplexer.begin()) {
+    if(!source.begin()) {
         logger.Error("Unable to initialize multiplexer");
         isSuccessful = false;
     }
 
     for (auto const &tempSensor: temperatureHumiditySensors) {
-        auto& ths = tempSensor.second;
-        if(multiplexerEnabled && ths.usesMultiplexer) {
-            //logger.Debug("Selecting multiplexer channel: %d", ths.multiplierChannel);
-            multiplexer.selectChannel(ths.multiplierChannel);
-        }
-
-        if (ths.sensor->init()) {
+        if (source.initSensor(tempSensor.first) != SENSOR_OK) {
             logger.Error("Unable to initialize sensor: %s", tempSensor.first.c_str());
             isSuccessful = false;
         }
-
-        if(multiplexerEnabled && ths.usesMultiplexer) {
-            //logger.Debug("Disabling multiplexer channel: %d", ths.multiplierChannel);
-            multiplexer.disableChannel(ths.multiplierChannel);
-        }
     }
 
     for (auto const &dustSensor: dustSensors) {
-        auto& ds = dustSensor.second;
-        if(multiplexerEnabled && ds.usesMultiplexer) {
-            //logger.Debug("Selecting multiplexer channel: %d", ds.multiplierChannel);
-            multiplexer.selectChannel(ds.multiplierChannel);
-        }
-
-        if (ds.sensor->init()) {
+        if (source.initSensor(dustSensor.first) != SENSOR_OK) {
             logger.Error("Unable to initialize sensor: %s", dustSensor.first.c_str());
             isSuccessful = false;
         }
-
-        if(multiplexerEnabled && ds.usesMultiplexer) {
-            //logger.Debug("Disabling multiplexer channel: %d", ds.multiplierChannel);
-            multiplexer.disableChannel(ds.multiplierChannel);
-        }
     }
 
     return isSuccessful;
 }
-
-SensorService::~SensorService() {
-    if(multiplexerEnabled) {
-        for (int chan = 0; chan < 8; chan++) {
-            multiplexer.disableChannel(chan);
-            delay(100);
-        }
-    }
-
-    // Sensors are owned by unique_ptr inside the structs, so they are released
-    // automatically when the maps are destroyed; no manual delete needed.
-}
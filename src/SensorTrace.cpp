@@ -0,0 +1,193 @@
+#include <cstring>
+#include "SensorTrace.h"
+
+static const uint8_t TRACE_MAGIC[4] = {'E', 'N', 'V', 'T'};
+
+static void put16(uint8_t *out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static void put32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint16_t get16(const uint8_t *in) {
+    return (uint16_t) in[0] | (uint16_t) in[1] << 8;
+}
+
+static uint32_t get32(const uint8_t *in) {
+    return (uint32_t) in[0] | (uint32_t) in[1] << 8 | (uint32_t) in[2] << 16 | (uint32_t) in[3] << 24;
+}
+
+static uint16_t saturate16(uint32_t value) {
+    return value > 0xFFFF ? 0xFFFF : (uint16_t) value;
+}
+
+SensorTraceWriter::SensorTraceWriter(Sink sink)
+        : sink(sink), synchronized(false), cyclesSinceSync(0), sensors() {
+}
+
+uint8_t SensorTraceWriter::sensorIndex(const std::string &name, uint8_t kind, uint8_t channel) {
+    for (size_t i = 0; i < sensors.size(); i++) {
+        if (sensors[i].name == name) {
+            return (uint8_t) i;
+        }
+    }
+
+    // First frame from this sensor: define it.
+    uint8_t index = (uint8_t) sensors.size();
+    sensors.push_back({name, kind, channel});
+    writeDefinition(index);
+    return index;
+}
+
+void SensorTraceWriter::writeDefinition(uint8_t index) {
+    // Names are capped at 255 bytes by the one-byte length field.
+    const Sensor &sensor = sensors[index];
+    size_t nameLength = sensor.name.size() > 0xFF ? 0xFF : sensor.name.size();
+    uint8_t record[5 + 0xFF];
+    record[0] = TRACE_RECORD_SENSOR;
+    record[1] = index;
+    record[2] = sensor.kind;
+    record[3] = sensor.channel;
+    record[4] = (uint8_t) nameLength;
+    memcpy(record + 5, sensor.name.data(), nameLength);
+    sink(record, 5 + nameLength);
+}
+
+void SensorTraceWriter::resynchronize() {
+    synchronized = false;
+}
+
+void SensorTraceWriter::cycle(uint32_t epoch, uint32_t uptimeMs) {
+    if (!synchronized || cyclesSinceSync >= TRACE_RESYNC_CYCLES) {
+        uint8_t header[6] = {TRACE_RECORD_HEADER, TRACE_MAGIC[0], TRACE_MAGIC[1], TRACE_MAGIC[2], TRACE_MAGIC[3],
+                             TRACE_VERSION};
+        sink(header, sizeof(header));
+        for (size_t i = 0; i < sensors.size(); i++) {
+            writeDefinition((uint8_t) i);
+        }
+        synchronized = true;
+        cyclesSinceSync = 0;
+    }
+    cyclesSinceSync++;
+
+    uint8_t record[9];
+    record[0] = TRACE_RECORD_CYCLE;
+    put32(record + 1, epoch);
+    put32(record + 5, uptimeMs);
+    sink(record, sizeof(record));
+}
+
+void SensorTraceWriter::temperatureHumidity(const std::string &name, uint8_t channel, int8_t status,
+                                            uint32_t durationUs, uint16_t rawTemperature, uint16_t rawHumidity) {
+    uint8_t index = sensorIndex(name, TRACE_KIND_SHT35, channel);
+
+    uint8_t record[9];
+    record[0] = TRACE_RECORD_TEMPERATURE_HUMIDITY;
+    record[1] = index;
+    record[2] = (uint8_t) status;
+    put16(record + 3, saturate16(durationUs));
+    put16(record + 5, rawTemperature);
+    put16(record + 7, rawHumidity);
+    sink(record, sizeof(record));
+}
+
+void SensorTraceWriter::dust(const std::string &name, uint8_t channel, int8_t status, uint32_t durationUs,
+                             const uint8_t *frame) {
+    uint8_t index = sensorIndex(name, TRACE_KIND_HM3301, channel);
+
+    uint8_t record[5 + DUST_FRAME_LENGTH];
+    record[0] = TRACE_RECORD_DUST;
+    record[1] = index;
+    record[2] = (uint8_t) status;
+    put16(record + 3, saturate16(durationUs));
+    memcpy(record + 5, frame, DUST_FRAME_LENGTH);
+    sink(record, sizeof(record));
+}
+
+SensorTraceReader::SensorTraceReader(const uint8_t *data, size_t length)
+        : data(data), length(length), position(0), error(false) {
+}
+
+bool SensorTraceReader::failed() const {
+    return error;
+}
+
+size_t SensorTraceReader::offset() const {
+    return position;
+}
+
+bool SensorTraceReader::next(TraceRecord &record) {
+    if (error || position >= length) {
+        return false;
+    }
+
+    const uint8_t *in = data + position;
+    size_t available = length - position;
+    size_t size;
+
+    record.type = in[0];
+    switch (record.type) {
+        case TRACE_RECORD_HEADER:
+            size = 6;
+            if (available < size || memcmp(in + 1, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+                error = true;
+                return false;
+            }
+            record.version = in[5];
+            break;
+        case TRACE_RECORD_SENSOR:
+            if (available < 5 || available < (size_t) 5 + in[4]) {
+                error = true;
+                return false;
+            }
+            size = 5 + in[4];
+            record.sensorIndex = in[1];
+            record.kind = in[2];
+            record.channel = in[3];
+            record.name.assign((const char *) in + 5, in[4]);
+            break;
+        case TRACE_RECORD_CYCLE:
+            size = 9;
+            if (available < size) {
+                error = true;
+                return false;
+            }
+            record.epoch = get32(in + 1);
+            record.uptimeMs = get32(in + 5);
+            break;
+        case TRACE_RECORD_TEMPERATURE_HUMIDITY:
+            size = 9;
+            if (available < size) {
+                error = true;
+                return false;
+            }
+            record.sensorIndex = in[1];
+            record.status = (int8_t) in[2];
+            record.durationUs = get16(in + 3);
+            record.rawTemperature = get16(in + 5);
+            record.rawHumidity = get16(in + 7);
+            break;
+        case TRACE_RECORD_DUST:
+            size = 5 + DUST_FRAME_LENGTH;
+            if (available < size) {
+                error = true;
+                return false;
+            }
+            record.sensorIndex = in[1];
+            record.status = (int8_t) in[2];
+            record.durationUs = get16(in + 3);
+            memcpy(record.frame, in + 5, DUST_FRAME_LENGTH);
+            break;
+        default:
+            error = true;
+            return false;
+    }
+
+    position += size;
+    return true;
+}
@@ -3,39 +3,39 @@
 #include "SerialLogger.h"
 
 SerialLogger::SerialLogger()
-        : PrintClass(Serial) {
+        : PrintClass(Serial), logBuffer(nullptr) {
 }
 
 SerialLogger::SerialLogger(Print &PrintClass)
-        : PrintClass(PrintClass) {
+        : PrintClass(PrintClass), logBuffer(nullptr) {
     printf_init(PrintClass);
 }
 
 void SerialLogger::Debug(const char *format, ...) {
     va_list args;
     va_start(args, format);
-    printMessage(LOG_LEVEL_DEBUG, format, args);
+    printMessage(LOG_LEVEL_DEBUG, LOG_SEVERITY_DEBUG, format, args);
     va_end(args);
 }
 
 void SerialLogger::Info(const char *format, ...) {
     va_list args;
     va_start(args, format);
-    printMessage(LOG_LEVEL_INFO, format, args);
+    printMessage(LOG_LEVEL_INFO, LOG_SEVERITY_INFO, format, args);
     va_end(args);
 }
 
 void SerialLogger::Warning(const char *format, ...) {
     va_list args;
     va_start(args, format);
-    printMessage(LOG_LEVEL_WARN, format, args);
+    printMessage(LOG_LEVEL_WARN, LOG_SEVERITY_WARN, format, args);
     va_end(args);
 }
 
 void SerialLogger::Error(const char *format, ...) {
     va_list args;
     va_start(args, format);
-    printMessage(LOG_LEVEL_ERROR, format, args);
+    printMessage(LOG_LEVEL_ERROR, LOG_SEVERITY_ERROR, format, args);
     va_end(args);
 }
 
@@ -50,7 +50,11 @@ void SerialLogger::LogNetworkInformation() {
     printMacAddress(mac);
 }
 
-void SerialLogger::printMessage(const char *logLevel, const char *format, va_list args) {
+void SerialLogger::setLogBuffer(LogBuffer *buffer) {
+    logBuffer = buffer;
+}
+
+void SerialLogger::printMessage(const char *logLevel, uint8_t severityNumber, const char *format, va_list args) {
     printTime();
 
     // Format into a fixed stack buffer and emit via PrintClass instead of the
@@ -64,6 +68,12 @@ void SerialLogger::printMessage(const char *logLevel, const char *format, va_lis
     vsnprintf(buf, sizeof(buf), format, args);
     PrintClass.print(buf);
     PrintClass.print("\n");
+
+    // The uptime lets records logged before the first NTP sync (e.g. sensor
+    // init errors in setup()) be restamped when they are exported.
+    if (logBuffer != nullptr && severityNumber >= LOG_SEVERITY_WARN) {
+        logBuffer->add(rtc.getEpoch(), millis(), severityNumber, buf);
+    }
 }
 
 void SerialLogger::printTime() {
@@ -0,0 +1,180 @@
+#include <cstring>
+#include "TraceSensorSource.h"
+#include "UdpLineExporter.h"
+
+TraceSensorSource::TraceSensorSource(const uint8_t *data, size_t length)
+        : reader(data, length), malformed(false), malformedOffset(0), statistics() {
+}
+
+bool TraceSensorSource::replay(SensorService &service, MetricExporter &exporter) {
+    TraceRecord record;
+    TraceRecord cycle;
+    bool inCycle = false;
+
+    // A cycle's reads (and the definitions of sensors read for the first time)
+    // follow its 'C' record, so a cycle is only sampled once the next one
+    // starts or the trace ends.
+    for (size_t start = reader.offset(); reader.next(record); start = reader.offset()) {
+        switch (record.type) {
+            case TRACE_RECORD_SENSOR:
+                defineSensor(service, record);
+                break;
+            case TRACE_RECORD_CYCLE:
+                if (inCycle) {
+                    runCycle(service, exporter, cycle);
+                }
+                cycle = record;
+                inCycle = true;
+                break;
+            case TRACE_RECORD_TEMPERATURE_HUMIDITY:
+            case TRACE_RECORD_DUST:
+                // Without its definition a read cannot be attributed, which
+                // means the trace was cut before its last header.
+                if (record.sensorIndex >= names.size() || names[record.sensorIndex].empty()) {
+                    malformed = true;
+                    malformedOffset = start;
+                    return false;
+                }
+                reads[names[record.sensorIndex]] = record;
+                break;
+            default:
+                break;
+        }
+    }
+    if (inCycle) {
+        runCycle(service, exporter, cycle);
+    }
+
+    return !reader.failed();
+}
+
+const TraceReplayStats &TraceSensorSource::stats() const {
+    return statistics;
+}
+
+size_t TraceSensorSource::errorOffset() const {
+    return malformed ? malformedOffset : reader.offset();
+}
+
+void TraceSensorSource::defineSensor(SensorService &service, const TraceRecord &record) {
+    if (record.sensorIndex >= names.size()) {
+        names.resize(record.sensorIndex + 1);
+    }
+    names[record.sensorIndex] = record.name;
+
+    // The trace does not record addresses; this source ignores them anyway.
+    bool multiplexed = record.channel != TRACE_NO_CHANNEL;
+    if (record.kind == TRACE_KIND_SHT35) {
+        if (multiplexed) {
+            service.addTemperatureHumiditySensor(record.name, "", (ushort) record.channel, 0);
+        } else {
+            service.addTemperatureHumiditySensor(record.name, "", (uint8_t) 0);
+        }
+    } else if (record.kind == TRACE_KIND_HM3301) {
+        if (multiplexed) {
+            service.addDustSensor(record.name, "", (ushort) record.channel, 0);
+        } else {
+            service.addDustSensor(record.name, "", (uint8_t) 0);
+        }
+    }
+}
+
+void TraceSensorSource::runCycle(SensorService &service, MetricExporter &exporter, const TraceRecord &cycle) {
+    statistics.cycles++;
+    service.sampleSensors(cycle.uptimeMs, cycle.epoch);
+    // Publish everything the cycle produced, however many batches it takes.
+    while (service.pendingSamples() > 0 && exporter.accepted(service.publishSamples(exporter))) {
+    }
+    reads.clear();
+}
+
+void TraceSensorSource::addTemperatureHumiditySensor(const std::string &name, uint8_t channel, uint8_t address) {
+}
+
+void TraceSensorSource::addDustSensor(const std::string &name, uint8_t channel, uint8_t address) {
+}
+
+bool TraceSensorSource::begin() {
+    return true;
+}
+
+int8_t TraceSensorSource::initSensor(const std::string &name) {
+    return SENSOR_OK;
+}
+
+bool TraceSensorSource::ready(const std::string &name) {
+    return reads.count(name) > 0;
+}
+
+int8_t TraceSensorSource::readTemperatureHumidity(const std::string &name, float &celsius, float &humidity) {
+    auto it = reads.find(name);
+    if (it == reads.end() || it->second.type != TRACE_RECORD_TEMPERATURE_HUMIDITY) {
+        return -1;
+    }
+    const TraceRecord &read = it->second;
+
+    statistics.temperatureHumidityReads++;
+    if (read.durationUs > statistics.maxTemperatureHumidityUs) {
+        statistics.maxTemperatureHumidityUs = read.durationUs;
+    }
+
+    // Like the driver, a failed read leaves the outputs untouched.
+    int8_t status = read.status;
+    if (status == SENSOR_OK) {
+        celsius = shtTemperatureFromRaw(read.rawTemperature);
+        humidity = shtHumidityFromRaw(read.rawHumidity);
+    } else {
+        statistics.readFailures++;
+    }
+    reads.erase(it);
+    return status;
+}
+
+int8_t TraceSensorSource::readDust(const std::string &name, uint8_t *frame) {
+    auto it = reads.find(name);
+    if (it == reads.end() || it->second.type != TRACE_RECORD_DUST) {
+        return -1;
+    }
+    const TraceRecord &read = it->second;
+
+    statistics.dustReads++;
+    if (read.durationUs > statistics.maxDustUs) {
+        statistics.maxDustUs = read.durationUs;
+    }
+
+    // The recorded frame is whatever was in the buffer after the read, so it
+    // is handed back even for a failed one.
+    int8_t status = read.status;
+    memcpy(frame, read.frame, DUST_FRAME_LENGTH);
+    DustReading reading;
+    if (status != SENSOR_OK) {
+        statistics.readFailures++;
+    } else if (!decodeDustFrame(frame, reading)) {
+        statistics.checksumFailures++;
+    }
+    reads.erase(it);
+    return status;
+}
+
+TraceDigestExporter::TraceDigestExporter()
+        : value(14695981039346656037ULL), exported(0) {
+}
+
+int TraceDigestExporter::exportMetrics(const std::vector<MetricPoint> &points) {
+    auto datagrams = UdpLineExporter::packDatagrams(points, UdpLineExporter::DEFAULT_MAX_DATAGRAM);
+    for (const auto &datagram: datagrams) {
+        for (char c: datagram) {
+            value = (value ^ (uint8_t) c) * 1099511628211ULL;
+        }
+    }
+    exported += points.size();
+    return datagrams.size();
+}
+
+uint64_t TraceDigestExporter::digest() const {
+    return value;
+}
+
+unsigned long TraceDigestExporter::points() const {
+    return exported;
+}
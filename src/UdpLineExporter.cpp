@@ -0,0 +1,118 @@
+#include <cstring>
+#include <sstream>
+#include "UdpLineExporter.h"
+
+UdpLineExporter::UdpLineExporter(UDP &udp, const char *host, uint16_t port, size_t maxDatagram)
+        : udp(udp), validHost(false), port(port), maxDatagram(maxDatagram) {
+    // Parse the dotted-quad once here; beginPacket(const char*) would otherwise
+    // do a DNS round trip through the radio on every datagram. A typo must not
+    // silently turn into sending everything to 0.0.0.0.
+    validHost = this->host.fromString(host);
+}
+
+bool UdpLineExporter::hostValid() const {
+    return validHost;
+}
+
+// Appends `value` with line-protocol escaping for measurement names and tag
+// keys/values: commas, spaces and (for tags) equals signs get a backslash.
+static void appendEscaped(std::string &line, const char *value, size_t length, bool escapeEquals) {
+    for (size_t i = 0; i < length; i++) {
+        char c = value[i];
+        if (c == ',' || c == ' ' || (escapeEquals && c == '=')) {
+            line += '\\';
+        }
+        line += c;
+    }
+}
+
+// Splits "environment.temperature_fahrenheit" into measurement "environment"
+// and field "temperature_fahrenheit". A metric without a dot becomes its own
+// measurement with a single "value" field.
+static void splitMetric(const char *metric, size_t &measurementLength, const char *&field) {
+    const char *dot = strchr(metric, '.');
+    if (dot == nullptr) {
+        measurementLength = strlen(metric);
+        field = "value";
+    } else {
+        measurementLength = dot - metric;
+        field = dot + 1;
+    }
+}
+
+static bool sameLine(const MetricPoint &a, const MetricPoint &b) {
+    size_t aLength, bLength;
+    const char *aField, *bField;
+    splitMetric(a.metric, aLength, aField);
+    splitMetric(b.metric, bLength, bField);
+    return a.epoch == b.epoch && aLength == bLength && strncmp(a.metric, b.metric, aLength) == 0 &&
+           strcmp(a.sensorName, b.sensorName) == 0 && strcmp(a.location, b.location) == 0;
+}
+
+std::vector<std::string> UdpLineExporter::packDatagrams(const std::vector<MetricPoint> &points, size_t maxDatagram) {
+    std::vector<std::string> datagrams;
+    std::string datagram;
+
+    size_t i = 0;
+    while (i < points.size()) {
+        const MetricPoint &head = points[i];
+        size_t measurementLength;
+        const char *field;
+        splitMetric(head.metric, measurementLength, field);
+
+        // measurement,sensor_name=<name>,location=<location> f1=v1,f2=v2 <ns>
+        std::string line;
+        appendEscaped(line, head.metric, measurementLength, false);
+        line += ",sensor_name=";
+        appendEscaped(line, head.sensorName, strlen(head.sensorName), true);
+        line += ",location=";
+        appendEscaped(line, head.location, strlen(head.location), true);
+
+        // Values go through stringstream for the same reason as the OTLP path
+        // (no float printf support needed).
+        std::stringstream fields;
+        bool first = true;
+        for (; i < points.size() && sameLine(head, points[i]); i++) {
+            splitMetric(points[i].metric, measurementLength, field);
+            fields << (first ? " " : ",") << field << "=" << points[i].value;
+            first = false;
+        }
+        // Nanosecond timestamp built by appending nine zeros to the epoch
+        // seconds, as in the OTLP exporter — no 64-bit math needed.
+        fields << " " << head.epoch << "000000000\n";
+        line += fields.str();
+
+        // Pack whole lines; start a new datagram when the next line would push
+        // this one past the MTU budget. A single oversized line still goes out
+        // on its own rather than being dropped.
+        if (!datagram.empty() && datagram.size() + line.size() > maxDatagram) {
+            datagrams.push_back(std::move(datagram));
+            datagram.clear();
+        }
+        datagram += line;
+    }
+
+    if (!datagram.empty()) {
+        datagrams.push_back(std::move(datagram));
+    }
+    return datagrams;
+}
+
+int UdpLineExporter::exportMetrics(const std::vector<MetricPoint> &points) {
+    if (!validHost) {
+        return -1;
+    }
+
+    int sent = 0;
+    for (const auto &datagram: packDatagrams(points, maxDatagram)) {
+        if (!udp.beginPacket(host, port)) {
+            return -1;
+        }
+        udp.write((const uint8_t *)datagram.c_str(), datagram.size());
+        if (!udp.endPacket()) {
+            return -1;
+        }
+        sent++;
+    }
+    return sent;
+}
@@ -0,0 +1,22 @@
+#include "WiFiMetricsListener.h"
+
+WiFiMetricsListener::WiFiMetricsListener(uint16_t port)
+        : server(port), started(false) {
+}
+
+void WiFiMetricsListener::begin() {
+    // WiFiNINA allocates a new listening socket on every begin(), so don't
+    // call it while the old one is still listening.
+    if (!started || server.status() != LISTEN) {
+        server.begin();
+        started = true;
+    }
+}
+
+Client *WiFiMetricsListener::accept() {
+    if (!started) {
+        return nullptr;
+    }
+    client = server.available();
+    return client ? &client : nullptr;
+}
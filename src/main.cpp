@@ -2,18 +2,24 @@
 #include <RTCZero.h>
 #include <Wire.h>
 #include <arduino-timer.h>
-#include <ArduinoHttpClient.h>
 #include <Adafruit_SleepyDog.h>
 
+#include "HardwareSensorSource.h"
 #include "SensorService.h"
 #include "SerialLogger.h"
+#include "LogBuffer.h"
+#include "SensorTrace.h"
+#include "MetricsServer.h"
+#include "WiFiMetricsListener.h"
+#include "OtlpHttpExporter.h"
+#include "UdpLineExporter.h"
 
 // Hardware watchdog: the SAMD21 WDT resets the board if it is not fed within this
 // window, recovering the device from hangs (a stalled WiFi/HTTP call or a wedged
 // I2C sensor read). ~16s is the SAMD21 maximum; Watchdog.enable() returns the
 // actual period it selected. HTTP_RESPONSE_TIMEOUT_MS is kept comfortably below
 // the WDT window so a merely-slow publish fails gracefully instead of tripping a
-// reset. The dog is fed each loop iteration, at the start of every read/publish
+// reset; it bounds the metrics and logs posts of a publish together. The dog is fed each loop iteration, at the start of every read/publish
 // tick, and while waiting on NTP.
 static const int WATCHDOG_TIMEOUT_MS = 16000;
 static const uint32_t HTTP_RESPONSE_TIMEOUT_MS = 8000;
@@ -27,26 +33,61 @@ const char PASS[] = SECRET_PASS;
 const char OTEL_HOST[] = OTEL_COLLECTOR_HOST;
 const int OTEL_PORT = OTEL_COLLECTOR_PORT;
 const char OTEL_METRICS_PATH[] = "/v1/metrics";
+const char OTEL_LOGS_PATH[] = "/v1/logs";
 const char OTEL_SVC_NAME[] = OTEL_SERVICE_NAME;
+const char UDP_LINE_HOST[] = UDP_LINE_COLLECTOR_HOST;
+const uint16_t UDP_LINE_PORT = UDP_LINE_COLLECTOR_PORT;
 int status = WL_IDLE_STATUS;
 
 WiFiConnectionHandler conMan(SSID, PASS);
 RTCZero rtc;
 SerialLogger Logger;
+// WARNING/ERROR records awaiting export with the next OTLP metric publish.
+LogBuffer logBuffer;
 
 auto timer = timer_create_default();
 
+#if METRICS_EXPORTER == EXPORTER_UDP_LINE
+// Fire-and-forget line protocol; no connection or response to wait on.
+WiFiUDP wiFiUdp;
+UdpLineExporter exporter(wiFiUdp, UDP_LINE_HOST, UDP_LINE_PORT);
+#else
 // Plain HTTP to the LAN Collector — no TLS is needed on-device (the Collector
 // performs the TLS hop to Grafana Cloud).
 WiFiClient wiFiClient;
+OtlpHttpExporter exporter(wiFiClient, Logger, OTEL_HOST, OTEL_PORT, OTEL_METRICS_PATH, OTEL_SVC_NAME,
+                          HTTP_RESPONSE_TIMEOUT_MS);
+#endif
 
-SensorService sensors(Logger, true);
+HardwareSensorSource sensorSource(true);
+SensorService sensors(Logger, sensorSource);
+
+#if SENSOR_TRACE_CAPTURE
+SensorTraceWriter traceWriter(writeTraceRecord);
+#endif
+
+#if METRICS_SERVER_ENABLED
+// Scrapes are answered from this snapshot only, never from the sensors.
+MetricsSnapshot metricsSnapshot;
+WiFiMetricsListener metricsListener(METRICS_SERVER_PORT);
+MetricsServer metricsServer(metricsListener, metricsSnapshot);
+#endif
 
 void setup() {
     Serial.begin(115200);
     delay(5000);
 
     Logger.Info("Startup");
+#if METRICS_EXPORTER == EXPORTER_UDP_LINE
+    if (!exporter.hostValid()) {
+        Logger.Error("UDP_LINE_COLLECTOR_HOST \"%s\" is not a valid IP address; nothing will be sent", UDP_LINE_HOST);
+    }
+#endif
+#if METRICS_EXPORTER != EXPORTER_UDP_LINE
+    // Only the OTLP exporter ships logs, so only buffer them when it is in use.
+    Logger.setLogBuffer(&logBuffer);
+    exporter.setLogBuffer(&logBuffer, OTEL_LOGS_PATH);
+#endif
 
     // Enable the watchdog early so a hang during sensor init also recovers.
     int wdtMs = Watchdog.enable(WATCHDOG_TIMEOUT_MS);
@@ -78,6 +119,14 @@ void setup() {
         }
     }
 
+#if SENSOR_TRACE_CAPTURE
+    Logger.Info("Sensor trace capture enabled");
+    sensors.setTraceWriter(&traceWriter);
+#endif
+#if METRICS_SERVER_ENABLED
+    sensors.setMetricsSnapshot(&metricsSnapshot);
+#endif
+
     if (!sensors.InitializeSensors()) {
         Logger.Error("Sensor initialization failed");
     }
@@ -85,7 +134,9 @@ void setup() {
     setDebugMessageLevel(DBG_INFO);
     conMan.addCallback(NetworkConnectionEvent::CONNECTED, onNetworkConnect);
 
-    timer.every(1000 * 30, readSensors);
+    sensors.setSamplingPeriods(TEMP_HUMIDITY_SAMPLING_PERIOD_MS, DUST_SAMPLING_PERIOD_MS);
+    timer.every(SAMPLING_TICK_MS, sampleSensors);
+    timer.every(PUBLISH_INTERVAL_MS, publishSensors);
     timer.every(1000 * 60 * 60, setRTC);
 }
 
@@ -93,65 +144,64 @@ void loop() {
     Watchdog.reset();
     conMan.check();
     timer.tick();
+#if METRICS_SERVER_ENABLED
+    metricsServer.poll();
+#endif
 }
 
-bool readSensors(void *argument) {
-    // Feed the dog right before the (blocking) sensor read + publish so a normal,
-    // slightly slow cycle never trips it; a true hang inside still will.
+bool sampleSensors(void *argument) {
+    // Feed the dog right before the (blocking) I2C reads so a normal, slightly
+    // slow tick never trips it; a true hang inside still will. Sampling keeps
+    // going while WiFi is down; readings queue up (bounded) until the next
+    // publish.
+    Watchdog.reset();
+#if SENSOR_TRACE_CAPTURE
+    // A monitor that attaches mid-run missed the header and the sensor
+    // definitions; send them again instead of waiting for the periodic resync.
+    // Checked here rather than in loop() since the USB check waits 10 ms.
+    static bool serialOpen = false;
+    bool open = (bool) Serial;
+    if (open && !serialOpen) {
+        traceWriter.resynchronize();
+    }
+    serialOpen = open;
+#endif
+    sensors.sampleSensors();
+    return true;
+}
+
+bool publishSensors(void *argument) {
     Watchdog.reset();
     if (WiFi.status() != WL_CONNECTED) {
         Logger.Info("Waiting on WiFi connection");
     }
     else {
-        int statusCode = sensors.readAndPublishSensors(&publishMessage, OTEL_SVC_NAME);
-        Logger.Debug("Finished reading and publishing sensors with a status code of %d", statusCode);
+        int statusCode = sensors.publishSamples(exporter);
+        Logger.Debug("Finished publishing sensors with a status code of %d (%d readings pending)", statusCode,
+                     (int) sensors.pendingSamples());
     }
     return true;
 }
 
-int publishMessage(const std::string& str) {
-    // Plain HTTP to the LAN OpenTelemetry Collector; it converts to protobuf and
-    // forwards to Grafana Cloud, so the device needs no TLS or credentials here.
-    HttpClient httpClient(wiFiClient, OTEL_HOST, OTEL_PORT);
-    // Bound the response wait below the watchdog window so a stalled collector
-    // returns an error here instead of tripping a watchdog reset.
-    httpClient.setHttpResponseTimeout(HTTP_RESPONSE_TIMEOUT_MS);
-
-    const char* payload = str.c_str();
-    size_t payloadLength = str.length();
-
-    Logger.Debug("Posting OTLP metrics to http://%s:%d%s", OTEL_HOST, OTEL_PORT, OTEL_METRICS_PATH);
-    //Logger.Debug("Payload %s", payload);
-    httpClient.beginRequest();
-    httpClient.post(OTEL_METRICS_PATH);
-    httpClient.sendHeader("Content-Type", "application/json");
-    httpClient.sendHeader(HTTP_HEADER_CONTENT_LENGTH, payloadLength);
-    httpClient.beginBody();
-    httpClient.write((const uint8_t *)payload, payloadLength);
-
-    // Read the status code exactly once.
-    int statusCode = httpClient.responseStatusCode();
-    //Logger.Debug("Finished HttpRequest with status code %d", statusCode);
-
-    // Always drain the response body so no bytes are left pending in the WiFi
-    // receive buffer; only log it on a non-2xx status. Pass it as a "%s" argument
-    // (not as the format string) so a body containing '%' is safe. A successful
-    // OTLP/HTTP export returns 200 with an empty or {"partialSuccess":{}} body.
-    String responseBody = httpClient.responseBody();
-    if(statusCode >= 300) {
-        Logger.Error("%s", responseBody.c_str());
+void writeTraceRecord(const uint8_t *record, size_t length) {
+    // One record per line, hex-encoded, so trace lines can be picked out of the
+    // regular log output on the same port.
+    static const char hex[] = "0123456789abcdef";
+    Serial.print("TRC ");
+    for (size_t i = 0; i < length; i++) {
+        Serial.write(hex[record[i] >> 4]);
+        Serial.write(hex[record[i] & 0x0F]);
     }
-
-    // Release the connection so socket buffers do not accumulate between the
-    // 30s publish cycles.
-    httpClient.stop();
-
-    return statusCode;
+    Serial.print("\n");
 }
 
 void onNetworkConnect() {
     Logger.LogNetworkInformation();
     setRTC(true);
+#if METRICS_SERVER_ENABLED
+    metricsServer.begin();
+    Logger.Info("Serving Prometheus metrics on port %d", METRICS_SERVER_PORT);
+#endif
 }
 
 bool setRTC(void *argument) {
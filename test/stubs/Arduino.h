@@ -0,0 +1,115 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <sys/types.h>      // ushort, which the SAMD core also provides
+#include "IPAddress.h"
+
+// Host stand-in for the Arduino core (native test env only). Covers just the
+// parts the firmware sources use.
+
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+
+inline unsigned long micros() {
+    static const auto started = std::chrono::steady_clock::now();
+    return (unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started).count();
+}
+
+inline unsigned long millis() {
+    return micros() / 1000;
+}
+
+inline void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            write(buffer[i]);
+        }
+        return size;
+    }
+
+    size_t print(const char *s) {
+        return write((const uint8_t *) s, strlen(s));
+    }
+
+    size_t print(char c) {
+        return write((uint8_t) c);
+    }
+
+    size_t print(unsigned char value, int base = DEC) {
+        return print((unsigned long) value, base);
+    }
+
+    size_t print(int value, int base = DEC) {
+        return print((long) value, base);
+    }
+
+    size_t print(unsigned int value, int base = DEC) {
+        return print((unsigned long) value, base);
+    }
+
+    size_t print(long value, int base = DEC) {
+        if (value < 0 && base == DEC) {
+            return print('-') + print((unsigned long) -value, base);
+        }
+        return print((unsigned long) value, base);
+    }
+
+    size_t print(unsigned long value, int base = DEC) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%lu", value);
+        return print(buf);
+    }
+
+    size_t print(const IPAddress &ip) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+        return print(buf);
+    }
+
+    size_t println() {
+        return print("\r\n");
+    }
+
+    size_t println(const char *s) {
+        return print(s) + println();
+    }
+
+    size_t println(const IPAddress &ip) {
+        return print(ip) + println();
+    }
+};
+
+class HostSerial : public Print {
+public:
+    using Print::write;
+
+    void begin(unsigned long baud) {
+    }
+
+    size_t write(uint8_t c) override {
+        return fputc(c, stdout) == EOF ? 0 : 1;
+    }
+};
+
+inline HostSerial Serial;
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <Arduino.h>
+
+// Host stand-in for the Arduino core Client interface (native test env
+// only); only the calls MetricsServer makes on an accepted connection.
+class Client : public Print {
+public:
+    using Print::write;
+
+    virtual int available() = 0;
+
+    virtual int read() = 0;
+
+    virtual uint8_t connected() = 0;
+
+    virtual void stop() = 0;
+
+    virtual operator bool() = 0;
+};
+
+#endif
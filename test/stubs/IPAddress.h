@@ -0,0 +1,56 @@
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <cstdint>
+
+// Host stand-in for the Arduino core IPAddress (native test env only). Covers
+// just the parts the firmware sources use.
+class IPAddress {
+public:
+    IPAddress() : bytes{0, 0, 0, 0} {
+    }
+
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth)
+            : bytes{first, second, third, fourth} {
+    }
+
+    // Parses a dotted quad; returns false (leaving the address unchanged) on
+    // anything else, as the Arduino implementation does.
+    bool fromString(const char *address) {
+        uint8_t parsed[4];
+        int part = 0;
+        int value = -1;
+        for (const char *c = address;; c++) {
+            if (*c >= '0' && *c <= '9') {
+                value = (value < 0 ? 0 : value * 10) + (*c - '0');
+                if (value > 255) {
+                    return false;
+                }
+            } else if ((*c == '.' || *c == '\0') && value >= 0 && part < 4) {
+                parsed[part++] = (uint8_t) value;
+                value = -1;
+                if (*c == '\0') {
+                    break;
+                }
+            } else {
+                return false;
+            }
+        }
+        if (part != 4) {
+            return false;
+        }
+        for (int i = 0; i < 4; i++) {
+            bytes[i] = parsed[i];
+        }
+        return true;
+    }
+
+    uint8_t operator[](int index) const {
+        return bytes[index];
+    }
+
+private:
+    uint8_t bytes[4];
+};
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef LIBPRINTF_H
+#define LIBPRINTF_H
+
+#include <Arduino.h>
+
+// Host stand-in for LibPrintf (native test env only). The host C library's
+// printf family already formats floats, so there is nothing to redirect.
+inline void printf_init(Print &print) {
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef NULLPRINT_H
+#define NULLPRINT_H
+
+#include <Arduino.h>
+
+// A Print that discards everything (host builds only), for a SerialLogger
+// whose output a test or tool does not look at.
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t c) override {
+        return 1;
+    }
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef RTCZERO_H
+#define RTCZERO_H
+
+#include <cstdint>
+#include <ctime>
+
+// Host stand-in for RTCZero (native test env only). Like the SAMD RTC, every
+// instance reads the same clock, which starts at the chip's reset value
+// (2000-01-01 00:00:00) and only moves when set.
+class RTCZero {
+public:
+    void begin() {
+    }
+
+    uint32_t getEpoch() {
+        return clock();
+    }
+
+    void setEpoch(uint32_t ts) {
+        clock() = ts;
+    }
+
+    uint8_t getSeconds() {
+        return now().tm_sec;
+    }
+
+    uint8_t getMinutes() {
+        return now().tm_min;
+    }
+
+    uint8_t getHours() {
+        return now().tm_hour;
+    }
+
+    uint8_t getDay() {
+        return now().tm_mday;
+    }
+
+    uint8_t getMonth() {
+        return now().tm_mon + 1;
+    }
+
+    uint8_t getYear() {
+        return now().tm_year - 100;
+    }
+
+private:
+    static uint32_t &clock() {
+        static uint32_t epoch = 946684800;
+        return epoch;
+    }
+
+    static tm now() {
+        time_t epoch = clock();
+        tm fields;
+        gmtime_r(&epoch, &fields);
+        return fields;
+    }
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef UDP_H
+#define UDP_H
+
+#include <cstddef>
+#include <cstdint>
+#include "IPAddress.h"
+
+// Host stand-in for the Arduino core UDP interface (native test env only);
+// only the sending half that UdpLineExporter uses.
+class UDP {
+public:
+    virtual ~UDP() = default;
+
+    virtual int beginPacket(IPAddress ip, uint16_t port) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+
+    virtual int endPacket() = 0;
+};
+
+#endif
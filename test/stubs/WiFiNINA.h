@@ -0,0 +1,23 @@
+#ifndef WIFININA_H
+#define WIFININA_H
+
+#include <cstring>
+#include "IPAddress.h"
+
+// Host stand-in for WiFiNINA (native test env only); only what SerialLogger
+// reports about the connection.
+class WiFiClass {
+public:
+    IPAddress localIP() {
+        return IPAddress();
+    }
+
+    uint8_t *macAddress(uint8_t *mac) {
+        memset(mac, 0, 6);
+        return mac;
+    }
+};
+
+inline WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,139 @@
+#include <cstring>
+#include <string>
+#include <unity.h>
+#include "LogBuffer.h"
+
+static const unsigned long EPOCH = 1700000000;
+
+static std::string exportAll(const LogBuffer &buffer) {
+    return buffer.toOtlpJson("env", buffer.size(), EPOCH + 600, 600000);
+}
+
+static bool contains(const std::string &haystack, const char *needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+static size_t occurrences(const std::string &haystack, const char *needle) {
+    size_t found = 0;
+    for (size_t at = haystack.find(needle); at != std::string::npos; at = haystack.find(needle, at + 1)) {
+        found++;
+    }
+    return found;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_repeated_messages_fold_into_one_record() {
+    LogBuffer buffer;
+    buffer.add(EPOCH, 1000, LOG_SEVERITY_WARN, "Read failed for sensor sensor1");
+    buffer.add(EPOCH + 5, 6000, LOG_SEVERITY_WARN, "Read failed for sensor sensor1");
+    buffer.add(EPOCH + 10, 11000, LOG_SEVERITY_WARN, "Read failed for sensor sensor1");
+    // Same text at another severity is a different record.
+    buffer.add(EPOCH + 10, 11000, LOG_SEVERITY_ERROR, "Read failed for sensor sensor1");
+
+    std::string json = exportAll(buffer);
+    TEST_ASSERT_EQUAL(2, buffer.size());
+    TEST_ASSERT_TRUE(contains(json, "\"timeUnixNano\":\"1700000000000000000\","
+                                    "\"observedTimeUnixNano\":\"1700000010000000000\""));
+    TEST_ASSERT_TRUE(contains(json, "{\"key\":\"log.repeat_count\",\"value\":{\"intValue\":\"3\"}}"));
+    TEST_ASSERT_TRUE(contains(json, "{\"key\":\"log.repeat_count\",\"value\":{\"intValue\":\"1\"}}"));
+}
+
+void test_rate_limit_drops_new_records_until_the_window_resets() {
+    LogBuffer buffer(2, 1000);
+    buffer.add(EPOCH, 0, LOG_SEVERITY_WARN, "first");
+    buffer.add(EPOCH, 100, LOG_SEVERITY_WARN, "second");
+    buffer.add(EPOCH, 200, LOG_SEVERITY_WARN, "third");
+    // Repeats of a kept record still fold in while the window is full.
+    buffer.add(EPOCH, 300, LOG_SEVERITY_WARN, "first");
+
+    TEST_ASSERT_EQUAL(2, buffer.size());
+    std::string json = exportAll(buffer);
+    TEST_ASSERT_FALSE(contains(json, "\"third\""));
+    TEST_ASSERT_TRUE(contains(json, "1 log records dropped (rate limit or buffer full)"));
+
+    buffer.add(EPOCH + 1, 1000, LOG_SEVERITY_WARN, "fourth");
+    TEST_ASSERT_EQUAL(3, buffer.size());
+    TEST_ASSERT_TRUE(contains(exportAll(buffer), "\"fourth\""));
+}
+
+void test_full_buffer_overwrites_the_oldest_record() {
+    LogBuffer buffer(LogBuffer::CAPACITY + 2);
+    char message[16];
+    for (size_t i = 0; i < LogBuffer::CAPACITY + 2; i++) {
+        snprintf(message, sizeof(message), "message %u", (unsigned) i);
+        buffer.add(EPOCH + i, i * 1000, LOG_SEVERITY_ERROR, message);
+    }
+
+    std::string json = exportAll(buffer);
+    TEST_ASSERT_EQUAL(LogBuffer::CAPACITY, buffer.size());
+    TEST_ASSERT_FALSE(contains(json, "\"message 0\""));
+    TEST_ASSERT_FALSE(contains(json, "\"message 1\""));
+    TEST_ASSERT_TRUE(json.find("\"message 2\"") < json.find("\"message 13\""));
+    TEST_ASSERT_TRUE(contains(json, "\"2 log records dropped (rate limit or buffer full)\""));
+    TEST_ASSERT_EQUAL(LogBuffer::CAPACITY + 1, occurrences(json, "\"severityNumber\""));
+}
+
+void test_discard_keeps_records_added_after_the_snapshot() {
+    LogBuffer buffer;
+    buffer.add(EPOCH, 0, LOG_SEVERITY_WARN, "exported one");
+    buffer.add(EPOCH, 0, LOG_SEVERITY_WARN, "exported two");
+    size_t pending = buffer.size();
+    std::string sent = buffer.toOtlpJson("env", pending, EPOCH, 0);
+
+    // Logged while the export was in flight.
+    buffer.add(EPOCH + 1, 1000, LOG_SEVERITY_ERROR, "logged during export");
+    buffer.discard(pending);
+
+    TEST_ASSERT_FALSE(contains(sent, "logged during export"));
+    TEST_ASSERT_EQUAL(1, buffer.size());
+    std::string json = exportAll(buffer);
+    TEST_ASSERT_TRUE(contains(json, "\"logged during export\""));
+    TEST_ASSERT_FALSE(contains(json, "exported"));
+}
+
+void test_discard_clears_the_dropped_tally() {
+    LogBuffer buffer(1);
+    buffer.add(EPOCH, 0, LOG_SEVERITY_WARN, "kept");
+    buffer.add(EPOCH, 0, LOG_SEVERITY_WARN, "dropped");
+    buffer.discard(buffer.size());
+
+    TEST_ASSERT_TRUE(buffer.empty());
+}
+
+void test_body_is_json_escaped() {
+    LogBuffer buffer;
+    buffer.add(EPOCH, 0, LOG_SEVERITY_WARN, "say \"hi\" C:\\dir\r\n\tend\x01");
+
+    TEST_ASSERT_TRUE(contains(exportAll(buffer),
+                              "\"body\":{\"stringValue\":\"say \\\"hi\\\" C:\\\\dir\\r\\n\\tend\\u0001\"}"));
+}
+
+// Records logged before the first NTP sync carry the RTC's year-2000 time.
+void test_records_before_clock_sync_are_restamped_from_uptime() {
+    LogBuffer buffer;
+    buffer.add(946684800 + 3, 3000, LOG_SEVERITY_ERROR, "Unable to initialize sensor: sensor2");
+
+    std::string json = buffer.toOtlpJson("env", 1, EPOCH, 63000);
+    TEST_ASSERT_TRUE(contains(json, "\"timeUnixNano\":\"1699999940000000000\""));
+    TEST_ASSERT_TRUE(contains(json, "{\"key\":\"device.uptime_ms\",\"value\":{\"intValue\":\"3000\"}}"));
+
+    json = buffer.toOtlpJson("env", 1, 946684800 + 63, 63000);
+    TEST_ASSERT_TRUE(contains(json, "\"timeUnixNano\":\"0\",\"observedTimeUnixNano\":\"0\""));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_repeated_messages_fold_into_one_record);
+    RUN_TEST(test_rate_limit_drops_new_records_until_the_window_resets);
+    RUN_TEST(test_full_buffer_overwrites_the_oldest_record);
+    RUN_TEST(test_discard_keeps_records_added_after_the_snapshot);
+    RUN_TEST(test_discard_clears_the_dropped_tally);
+    RUN_TEST(test_body_is_json_escaped);
+    RUN_TEST(test_records_before_clock_sync_are_restamped_from_uptime);
+    return UNITY_END();
+}
@@ -0,0 +1,301 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "MetricsServer.h"
+
+// Serves scrapes over real loopback sockets: the server side accepts through
+// PosixListener, and each test scrapes it like Prometheus would, calling
+// poll() the way loop() does.
+
+class PosixClient : public Client {
+public:
+    explicit PosixClient(int fd = -1) : fd(fd) {
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        ssize_t sent = send(fd, buffer, size, MSG_NOSIGNAL);
+        return sent < 0 ? 0 : (size_t) sent;
+    }
+
+    int available() override {
+        int pending = 0;
+        return ioctl(fd, FIONREAD, &pending) < 0 ? 0 : pending;
+    }
+
+    int read() override {
+        uint8_t c;
+        return recv(fd, &c, 1, MSG_DONTWAIT) == 1 ? c : -1;
+    }
+
+    uint8_t connected() override {
+        char c;
+        ssize_t peeked = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        return fd >= 0 && (peeked > 0 || (peeked < 0 && errno == EAGAIN));
+    }
+
+    void stop() override {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    operator bool() override {
+        return fd >= 0;
+    }
+
+private:
+    int fd;
+};
+
+class PosixListener : public MetricsListener {
+public:
+    PosixListener() : fd(-1), port(0) {
+    }
+
+    ~PosixListener() override {
+        client.stop();
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    void begin() override {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = sockaddr_in();
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd, (sockaddr *) &address, sizeof(address));
+        listen(fd, 4);
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        socklen_t length = sizeof(address);
+        getsockname(fd, (sockaddr *) &address, &length);
+        port = ntohs(address.sin_port);
+    }
+
+    Client *accept() override {
+        int accepted = ::accept(fd, nullptr, nullptr);
+        if (accepted < 0) {
+            return nullptr;
+        }
+        client = PosixClient(accepted);
+        return &client;
+    }
+
+    int fd;
+    uint16_t port;
+
+private:
+    PosixClient client;
+};
+
+// The scraping side of one connection.
+class Scraper {
+public:
+    explicit Scraper(uint16_t port) : fd(socket(AF_INET, SOCK_STREAM, 0)) {
+        sockaddr_in address = sockaddr_in();
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        connect(fd, (sockaddr *) &address, sizeof(address));
+    }
+
+    ~Scraper() {
+        close(fd);
+    }
+
+    void send(const char *text) {
+        ::send(fd, text, strlen(text), MSG_NOSIGNAL);
+    }
+
+    // Everything received so far; true once the server has closed.
+    bool receive(std::string &response) {
+        char buffer[1024];
+        ssize_t length;
+        while ((length = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+            response.append(buffer, length);
+        }
+        return length == 0;
+    }
+
+    int fd;
+};
+
+static std::vector<MetricPoint> cycle(unsigned long epoch) {
+    return {
+            {"environment.temperature_fahrenheit", 71.25, epoch, "sensor1", "crawlspace"},
+            {"environment.humidity_percent", 45, epoch, "sensor1", "crawlspace"},
+            {"environment.pm2_5_ugm3", 12, epoch, "dustsensor1", "garage"},
+    };
+}
+
+// Polls the way loop() does until the server has answered and closed, or a
+// second has passed. Returns the time it took.
+static unsigned long scrape(MetricsServer &server, Scraper &scraper, std::string &response) {
+    unsigned long started = millis();
+    while (!scraper.receive(response) && millis() - started < 1000) {
+        server.poll();
+    }
+    return millis() - started;
+}
+
+static std::string expectedResponse(const char *status, const std::string &body) {
+    return std::string("HTTP/1.1 ") + status +
+           "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+           std::to_string(body.length()) + "\r\nConnection: close\r\n\r\n" + body;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_serves_the_snapshot() {
+    MetricsSnapshot snapshot;
+    snapshot.publish(cycle(1700000000));
+    PosixListener listener;
+    MetricsServer server(listener, snapshot);
+    server.begin();
+
+    Scraper scraper(listener.port);
+    scraper.send("GET /metrics HTTP/1.1\r\nHost: board\r\nAccept: text/plain\r\n\r\n");
+    std::string response;
+    scrape(server, scraper, response);
+
+    TEST_ASSERT_EQUAL_STRING(expectedResponse("200 OK", snapshot.current()).c_str(), response.c_str());
+}
+
+void test_other_paths_get_not_found() {
+    MetricsSnapshot snapshot;
+    PosixListener listener;
+    MetricsServer server(listener, snapshot);
+    server.begin();
+
+    Scraper scraper(listener.port);
+    scraper.send("GET /metricsx HTTP/1.1\r\n\r\n");
+    std::string response;
+    scrape(server, scraper, response);
+
+    TEST_ASSERT_EQUAL_STRING(expectedResponse("404 Not Found", "Not Found\n").c_str(), response.c_str());
+}
+
+// A body larger than one write chunk arrives whole and in order.
+void test_serves_a_multi_chunk_snapshot() {
+    std::vector<MetricPoint> points;
+    for (unsigned long i = 0; i < 40; i++) {
+        for (const auto &point: cycle(1700000000 + i)) {
+            points.push_back(point);
+        }
+    }
+    MetricsSnapshot snapshot;
+    snapshot.publish(points);
+    TEST_ASSERT_GREATER_THAN(2048, snapshot.current().length());
+    PosixListener listener;
+    MetricsServer server(listener, snapshot);
+    server.begin();
+
+    Scraper scraper(listener.port);
+    scraper.send("GET /metrics HTTP/1.1\r\n\r\n");
+    std::string response;
+    scrape(server, scraper, response);
+
+    TEST_ASSERT_TRUE(response == expectedResponse("200 OK", snapshot.current()));
+}
+
+// A request line that arrives in pieces is picked up across polls; no
+// single poll() waits for the rest.
+void test_partial_request_does_not_block_poll() {
+    MetricsSnapshot snapshot;
+    snapshot.publish(cycle(1700000000));
+    PosixListener listener;
+    MetricsServer server(listener, snapshot);
+    server.begin();
+
+    Scraper scraper(listener.port);
+    scraper.send("GET /met");
+    std::string response;
+    for (int i = 0; i < 20; i++) {
+        auto started = std::chrono::steady_clock::now();
+        server.poll();
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        TEST_ASSERT_LESS_THAN(5000, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        delay(1);
+    }
+    TEST_ASSERT_FALSE(scraper.receive(response));
+    TEST_ASSERT_EQUAL(0, response.length());
+
+    scraper.send("rics HTTP/1.1\r\n\r\n");
+    scrape(server, scraper, response);
+    TEST_ASSERT_EQUAL_STRING(expectedResponse("200 OK", snapshot.current()).c_str(), response.c_str());
+}
+
+// A client that never finishes its request line is dropped after the request
+// timeout, and the next scrape is served.
+void test_stalled_request_is_dropped() {
+    MetricsSnapshot snapshot;
+    snapshot.publish(cycle(1700000000));
+    PosixListener listener;
+    MetricsServer server(listener, snapshot);
+    server.begin();
+
+    Scraper stalled(listener.port);
+    stalled.send("GET /metrics");
+    std::string response;
+    unsigned long started = millis();
+    while (!stalled.receive(response) && millis() - started < 4000) {
+        server.poll();
+        delay(1);
+    }
+    unsigned long elapsed = millis() - started;
+    TEST_ASSERT_EQUAL(0, response.length());
+    TEST_ASSERT_GREATER_THAN(1900, elapsed);
+    TEST_ASSERT_LESS_THAN(3000, elapsed);
+
+    Scraper scraper(listener.port);
+    scraper.send("GET /metrics HTTP/1.1\r\n\r\n");
+    scrape(server, scraper, response);
+    TEST_ASSERT_EQUAL_STRING(expectedResponse("200 OK", snapshot.current()).c_str(), response.c_str());
+}
+
+// From a complete request to a complete response takes a handful of polls,
+// not a wait on the network.
+void test_scrape_latency_is_bounded() {
+    MetricsSnapshot snapshot;
+    snapshot.publish(cycle(1700000000));
+    PosixListener listener;
+    MetricsServer server(listener, snapshot);
+    server.begin();
+
+    for (int i = 0; i < 10; i++) {
+        Scraper scraper(listener.port);
+        scraper.send("GET /metrics HTTP/1.1\r\n\r\n");
+        std::string response;
+        TEST_ASSERT_LESS_THAN(50, scrape(server, scraper, response));
+        TEST_ASSERT_EQUAL_STRING(expectedResponse("200 OK", snapshot.current()).c_str(), response.c_str());
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_serves_the_snapshot);
+    RUN_TEST(test_other_paths_get_not_found);
+    RUN_TEST(test_serves_a_multi_chunk_snapshot);
+    RUN_TEST(test_partial_request_does_not_block_poll);
+    RUN_TEST(test_stalled_request_is_dropped);
+    RUN_TEST(test_scrape_latency_is_bounded);
+    return UNITY_END();
+}
@@ -0,0 +1,69 @@
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "MetricsSnapshot.h"
+
+static std::vector<MetricPoint> cycle(double temperature) {
+    return {
+            {"environment.temperature_fahrenheit", temperature, 1700000000, "sensor1", "crawlspace"},
+            {"environment.humidity_percent", 45, 1700000000, "sensor1", "crawlspace"},
+            {"environment.temperature_fahrenheit", 68.5, 1700000000, "sensor2", "attic"},
+    };
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_groups_samples_under_one_type_line_per_metric() {
+    TEST_ASSERT_EQUAL_STRING(
+            "# TYPE environment_temperature_fahrenheit gauge\n"
+            "environment_temperature_fahrenheit{sensor_name=\"sensor1\",location=\"crawlspace\"} 71.25\n"
+            "environment_temperature_fahrenheit{sensor_name=\"sensor2\",location=\"attic\"} 68.5\n"
+            "# TYPE environment_humidity_percent gauge\n"
+            "environment_humidity_percent{sensor_name=\"sensor1\",location=\"crawlspace\"} 45\n",
+            MetricsSnapshot::render(cycle(71.25)).c_str());
+}
+
+void test_escapes_label_values_and_metric_names() {
+    std::vector<MetricPoint> points = {{"env-room.pm2.5", 12, 1, "dust\"1\"", "back\\yard\nnorth"}};
+
+    TEST_ASSERT_EQUAL_STRING(
+            "# TYPE env_room_pm2_5 gauge\n"
+            "env_room_pm2_5{sensor_name=\"dust\\\"1\\\"\",location=\"back\\\\yard\\nnorth\"} 12\n",
+            MetricsSnapshot::render(points).c_str());
+}
+
+void test_empty_before_first_publish() {
+    MetricsSnapshot snapshot;
+
+    TEST_ASSERT_EQUAL(0, snapshot.generation());
+    TEST_ASSERT_EQUAL_STRING("", snapshot.current().c_str());
+}
+
+// A scrape holding the current buffer keeps a complete copy of it while the
+// next publish renders into the other one.
+void test_publish_leaves_the_served_buffer_intact() {
+    MetricsSnapshot snapshot;
+    snapshot.publish(cycle(71.25));
+    const std::string &served = snapshot.current();
+    const std::string first = MetricsSnapshot::render(cycle(71.25));
+
+    snapshot.publish(cycle(72.5));
+
+    TEST_ASSERT_EQUAL(2, snapshot.generation());
+    TEST_ASSERT_EQUAL_STRING(first.c_str(), served.c_str());
+    TEST_ASSERT_EQUAL_STRING(MetricsSnapshot::render(cycle(72.5)).c_str(), snapshot.current().c_str());
+    TEST_ASSERT_TRUE(&served != &snapshot.current());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_groups_samples_under_one_type_line_per_metric);
+    RUN_TEST(test_escapes_label_values_and_metric_names);
+    RUN_TEST(test_empty_before_first_publish);
+    RUN_TEST(test_publish_leaves_the_served_buffer_intact);
+    return UNITY_END();
+}
@@ -0,0 +1,41 @@
+#ifndef FIXTURE_TRACE_H
+#define FIXTURE_TRACE_H
+
+#include <cstdint>
+
+// Four cycles from two SHT35s (sensor1 on TCA9548 channel 0, sensor2 wired
+// directly) and one HM3301 (dustsensor1 on channel 2), written with
+// SensorTraceWriter. SHT35 values are stored as raw 16-bit words, so they
+// decode to the nearest step rather than exactly:
+//
+//   1700000000  sensor1 22.50 °C 45.00 %, sensor2 18.25 °C 61.50 %,
+//               dustsensor1 PM1.0/2.5/10 = 4/7/9
+//   1700000010  dustsensor1 5/8/11
+//   1700000020  sensor1 read fails (ERROR_COMM), dustsensor1 bad checksum
+//   1700000030  sensor2 18.50 °C 60.75 %, dustsensor1 12/20/31
+static const uint8_t FIXTURE_TRACE[] = {
+    0x48, 0x45, 0x4e, 0x56, 0x54, 0x01, 0x43, 0x00, 0xf1, 0x53, 0x65, 0x60,
+    0xea, 0x00, 0x00, 0x53, 0x00, 0x01, 0x00, 0x07, 0x73, 0x65, 0x6e, 0x73,
+    0x6f, 0x72, 0x31, 0x54, 0x00, 0x00, 0x72, 0x10, 0xbe, 0x62, 0x33, 0x73,
+    0x53, 0x01, 0x01, 0xff, 0x07, 0x73, 0x65, 0x6e, 0x73, 0x6f, 0x72, 0x32,
+    0x54, 0x01, 0x00, 0x5e, 0x10, 0x86, 0x5c, 0x70, 0x9d, 0x53, 0x02, 0x02,
+    0x02, 0x0b, 0x64, 0x75, 0x73, 0x74, 0x73, 0x65, 0x6e, 0x73, 0x6f, 0x72,
+    0x31, 0x44, 0x02, 0x00, 0x26, 0x07, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04,
+    0x00, 0x07, 0x00, 0x09, 0x00, 0x04, 0x00, 0x07, 0x00, 0x09, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0x43,
+    0x0a, 0xf1, 0x53, 0x65, 0x70, 0x11, 0x01, 0x00, 0x44, 0x02, 0x00, 0x21,
+    0x07, 0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x00, 0x08, 0x00, 0x0b, 0x00,
+    0x05, 0x00, 0x08, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x31, 0x43, 0x14, 0xf1, 0x53, 0x65, 0x80,
+    0x38, 0x01, 0x00, 0x54, 0x00, 0xfe, 0xff, 0xff, 0xd4, 0x41, 0x00, 0x00,
+    0x44, 0x02, 0x00, 0x30, 0x07, 0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00,
+    0x09, 0x00, 0x0c, 0x00, 0x06, 0x00, 0x09, 0x00, 0x0c, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x43, 0x1e,
+    0xf1, 0x53, 0x65, 0x90, 0x5f, 0x01, 0x00, 0x54, 0x01, 0x00, 0x68, 0x10,
+    0xe4, 0x5c, 0x85, 0x9b, 0x44, 0x02, 0x00, 0x2b, 0x07, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x0c, 0x00, 0x14, 0x00, 0x1f, 0x00, 0x0c, 0x00, 0x14, 0x00,
+    0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x7f
+};
+
+#endif
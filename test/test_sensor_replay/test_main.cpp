@@ -0,0 +1,171 @@
+#include <string>
+#include <vector>
+#include <unity.h>
+#include <NullPrint.h>
+#include "SensorService.h"
+#include "SerialLogger.h"
+#include "TraceSensorSource.h"
+#include "UdpLineExporter.h"
+#include "fixture_trace.h"
+
+// Replays the fixture trace through the real SensorService, the way
+// tools/trace_replay does, and checks what it publishes.
+
+// Keeps the line protocol of every published batch.
+class RecordingExporter : public MetricExporter {
+public:
+    int exportMetrics(const std::vector<MetricPoint> &points) override {
+        for (const auto &datagram: UdpLineExporter::packDatagrams(points, UdpLineExporter::DEFAULT_MAX_DATAGRAM)) {
+            lines += datagram;
+        }
+        return 1;
+    }
+
+    std::string lines;
+};
+
+static NullPrint output;
+static SerialLogger logger(output);
+
+static std::vector<uint8_t> written;
+
+static void writeRecord(const uint8_t *record, size_t length) {
+    written.insert(written.end(), record, record + length);
+}
+
+// Offset of the n-th (from 1) record of `type` in `trace`.
+static size_t recordOffset(const uint8_t *trace, size_t length, char type, int n) {
+    SensorTraceReader reader(trace, length);
+    TraceRecord record;
+    for (size_t start = reader.offset(); reader.next(record); start = reader.offset()) {
+        if (record.type == type && --n == 0) {
+            return start;
+        }
+    }
+    return length;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_replay_publishes_decoded_readings() {
+    TraceSensorSource source(FIXTURE_TRACE, sizeof(FIXTURE_TRACE));
+    SensorService service(logger, source);
+    RecordingExporter exporter;
+
+    TEST_ASSERT_TRUE(source.replay(service, exporter));
+    TEST_ASSERT_EQUAL_STRING(
+            "environment,sensor_name=sensor1,location= temperature_fahrenheit=72.501,humidity_percent=45.0004 1700000000000000000\n"
+            "environment,sensor_name=sensor2,location= temperature_fahrenheit=64.8489,humidity_percent=61.5 1700000000000000000\n"
+            "environment,sensor_name=dustsensor1,location= pm1_0_ugm3=4,pm2_5_ugm3=7,pm10_ugm3=9 1700000000000000000\n"
+            "environment,sensor_name=dustsensor1,location= pm1_0_ugm3=5,pm2_5_ugm3=8,pm10_ugm3=11 1700000010000000000\n"
+            "environment,sensor_name=sensor1,location= temperature_fahrenheit=32,humidity_percent=0 1700000020000000000\n"
+            "environment,sensor_name=dustsensor1,location= pm1_0_ugm3=0,pm2_5_ugm3=0,pm10_ugm3=0 1700000020000000000\n"
+            "environment,sensor_name=sensor2,location= temperature_fahrenheit=65.3008,humidity_percent=60.7507 1700000030000000000\n"
+            "environment,sensor_name=dustsensor1,location= pm1_0_ugm3=12,pm2_5_ugm3=20,pm10_ugm3=31 1700000030000000000\n",
+            exporter.lines.c_str());
+}
+
+void test_replay_counts_reads_and_failures() {
+    TraceSensorSource source(FIXTURE_TRACE, sizeof(FIXTURE_TRACE));
+    SensorService service(logger, source);
+    TraceDigestExporter exporter;
+
+    TEST_ASSERT_TRUE(source.replay(service, exporter));
+    TEST_ASSERT_EQUAL(4, source.stats().cycles);
+    TEST_ASSERT_EQUAL(4, source.stats().temperatureHumidityReads);
+    TEST_ASSERT_EQUAL(4, source.stats().dustReads);
+    TEST_ASSERT_EQUAL(1, source.stats().readFailures);
+    TEST_ASSERT_EQUAL(1, source.stats().checksumFailures);
+    TEST_ASSERT_EQUAL(65535, source.stats().maxTemperatureHumidityUs);
+    TEST_ASSERT_EQUAL(1840, source.stats().maxDustUs);
+    TEST_ASSERT_EQUAL(20, exporter.points());
+}
+
+// The stored digest of the fixture. It only changes when the decoded
+// readings, their names or their timestamps do.
+void test_replay_digest_matches_fixture() {
+    TraceSensorSource source(FIXTURE_TRACE, sizeof(FIXTURE_TRACE));
+    SensorService service(logger, source);
+    TraceDigestExporter exporter;
+
+    TEST_ASSERT_TRUE(source.replay(service, exporter));
+    TEST_ASSERT_EQUAL_HEX64(0x91d46365545d77d9ULL, exporter.digest());
+}
+
+void test_truncated_trace_fails() {
+    TraceSensorSource source(FIXTURE_TRACE, sizeof(FIXTURE_TRACE) - 3);
+    SensorService service(logger, source);
+    TraceDigestExporter exporter;
+
+    TEST_ASSERT_FALSE(source.replay(service, exporter));
+}
+
+// A capture that starts after the sensor definitions cannot attribute its
+// reads, so it must not replay as an empty but valid run.
+void test_trace_cut_before_definitions_fails() {
+    size_t start = recordOffset(FIXTURE_TRACE, sizeof(FIXTURE_TRACE), TRACE_RECORD_CYCLE, 2);
+    TEST_ASSERT_LESS_THAN(sizeof(FIXTURE_TRACE), start);
+    TraceSensorSource source(FIXTURE_TRACE + start, sizeof(FIXTURE_TRACE) - start);
+    SensorService service(logger, source);
+    TraceDigestExporter exporter;
+
+    TEST_ASSERT_FALSE(source.replay(service, exporter));
+    TEST_ASSERT_EQUAL(9, source.errorOffset());
+    TEST_ASSERT_EQUAL(0, exporter.points());
+}
+
+// The writer repeats the header and definitions, so a capture that starts
+// at any later header replays on its own.
+void test_capture_replays_from_resync() {
+    written.clear();
+    SensorTraceWriter writer(writeRecord);
+    for (uint32_t i = 0; i < TRACE_RESYNC_CYCLES + 2; i++) {
+        writer.cycle(1700000000 + 10 * i, 10000 * i);
+        writer.temperatureHumidity("sensor1", 2, 0, 1200, 0x6666, 0x7333);
+    }
+
+    size_t start = recordOffset(written.data(), written.size(), TRACE_RECORD_HEADER, 2);
+    TEST_ASSERT_LESS_THAN(written.size(), start);
+    TraceSensorSource source(written.data() + start, written.size() - start);
+    SensorService service(logger, source);
+    RecordingExporter exporter;
+
+    TEST_ASSERT_TRUE(source.replay(service, exporter));
+    TEST_ASSERT_EQUAL(2, source.stats().cycles);
+    TEST_ASSERT_EQUAL(2, source.stats().temperatureHumidityReads);
+    TEST_ASSERT_EQUAL_STRING(
+            "environment,sensor_name=sensor1,location= temperature_fahrenheit=77,humidity_percent=45.0004 1700000600000000000\n"
+            "environment,sensor_name=sensor1,location= temperature_fahrenheit=77,humidity_percent=45.0004 1700000610000000000\n",
+            exporter.lines.c_str());
+}
+
+void test_resynchronize_repeats_header_on_next_cycle() {
+    written.clear();
+    SensorTraceWriter writer(writeRecord);
+    writer.cycle(1700000000, 0);
+    writer.dust("dustsensor1", 3, 0, 1800, FIXTURE_TRACE);
+    writer.cycle(1700000010, 10000);
+    TEST_ASSERT_EQUAL(written.size(), recordOffset(written.data(), written.size(), TRACE_RECORD_HEADER, 2));
+
+    writer.resynchronize();
+    writer.cycle(1700000020, 20000);
+    size_t header = recordOffset(written.data(), written.size(), TRACE_RECORD_HEADER, 2);
+    TEST_ASSERT_LESS_THAN(written.size(), header);
+    TEST_ASSERT_EQUAL(header + 6, recordOffset(written.data(), written.size(), TRACE_RECORD_SENSOR, 2));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_publishes_decoded_readings);
+    RUN_TEST(test_replay_counts_reads_and_failures);
+    RUN_TEST(test_replay_digest_matches_fixture);
+    RUN_TEST(test_truncated_trace_fails);
+    RUN_TEST(test_trace_cut_before_definitions_fails);
+    RUN_TEST(test_capture_replays_from_resync);
+    RUN_TEST(test_resynchronize_repeats_header_on_next_cycle);
+    return UNITY_END();
+}
@@ -0,0 +1,264 @@
+#include <climits>
+#include <map>
+#include <string>
+#include <vector>
+#include <unity.h>
+#include <NullPrint.h>
+#include "MetricsSnapshot.h"
+#include "SensorService.h"
+#include "SerialLogger.h"
+
+// Every sensor is always ready and reads the same values. Each read is logged
+// under the sensor's name at the uptime the test last set in `now`.
+class FixedSource : public SensorSource {
+public:
+    void addTemperatureHumiditySensor(const std::string &name, uint8_t channel, uint8_t address) override {
+    }
+
+    void addDustSensor(const std::string &name, uint8_t channel, uint8_t address) override {
+    }
+
+    bool begin() override {
+        return true;
+    }
+
+    int8_t initSensor(const std::string &name) override {
+        return SENSOR_OK;
+    }
+
+    bool ready(const std::string &name) override {
+        return true;
+    }
+
+    int8_t readTemperatureHumidity(const std::string &name, float &celsius, float &humidity) override {
+        reads[name].push_back(now);
+        celsius = 20;
+        humidity = 50;
+        return SENSOR_OK;
+    }
+
+    int8_t readDust(const std::string &name, uint8_t *frame) override {
+        reads[name].push_back(now);
+        return -2;
+    }
+
+    unsigned long now = 0;
+    std::map<std::string, std::vector<unsigned long>> reads;
+};
+
+// Accepts or rejects every batch, keeping the size of each one it was given.
+class ScriptedExporter : public MetricExporter {
+public:
+    int exportMetrics(const std::vector<MetricPoint> &points) override {
+        batches.push_back(points.size());
+        return statusCode;
+    }
+
+    bool accepted(int statusCode) const override {
+        return statusCode >= 200 && statusCode < 300;
+    }
+
+    int statusCode = 200;
+    std::vector<size_t> batches;
+};
+
+static NullPrint output;
+static SerialLogger logger(output);
+
+// 2023-11-14, well after the first NTP sync.
+static const unsigned long SYNCED_EPOCH = 1700000000;
+
+// Two sensors, sampled on every tick: four points per tick.
+static void addSensors(SensorService &service) {
+    service.addTemperatureHumiditySensor("sensor1", "crawlspace", (uint8_t) 0x45);
+    service.addTemperatureHumiditySensor("sensor2", "crawlspace", (uint8_t) 0x45);
+}
+
+// The firmware's defaults: three SHT35s every 2 min and an HM3301 every
+// 10 s, sampled on a 5 s tick.
+static void addDefaultSensors(SensorService &service) {
+    service.addTemperatureHumiditySensor("sensor1", "crawlspace", (uint8_t) 0x45);
+    service.addTemperatureHumiditySensor("sensor2", "attic", (uint8_t) 0x45);
+    service.addTemperatureHumiditySensor("sensor3", "garage", (uint8_t) 0x45);
+    service.addDustSensor("dustsensor1", "garage", (uint8_t) 0x40);
+}
+
+// Runs `ticks` sampling ticks `tickMs` apart, the first one `tickMs` after
+// `start`, as timer.every() does.
+static void runTicks(SensorService &service, FixedSource &source, unsigned long start, unsigned long tickMs,
+                     unsigned long ticks) {
+    for (unsigned long tick = 1; tick <= ticks; tick++) {
+        source.now = start + tick * tickMs;
+        service.sampleSensors(source.now, SYNCED_EPOCH + tick * tickMs / 1000);
+    }
+}
+
+// Checks that `reads` are exactly first, first + period, ... up to `last`.
+static void assertReadEvery(const std::vector<unsigned long> &reads, unsigned long first, unsigned long period,
+                            unsigned long last) {
+    TEST_ASSERT_EQUAL((last - first) / period + 1, reads.size());
+    for (size_t i = 0; i < reads.size(); i++) {
+        TEST_ASSERT_EQUAL(first + i * period, reads[i]);
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_failed_export_keeps_the_batch() {
+    FixedSource source;
+    SensorService service(logger, source);
+    ScriptedExporter exporter;
+    addSensors(service);
+    service.sampleSensors(0, SYNCED_EPOCH);
+
+    exporter.statusCode = 503;
+    TEST_ASSERT_EQUAL(503, service.publishSamples(exporter));
+    TEST_ASSERT_EQUAL(4, service.pendingSamples());
+
+    exporter.statusCode = -3;
+    TEST_ASSERT_EQUAL(-3, service.publishSamples(exporter));
+    TEST_ASSERT_EQUAL(4, service.pendingSamples());
+
+    exporter.statusCode = 200;
+    TEST_ASSERT_EQUAL(200, service.publishSamples(exporter));
+    TEST_ASSERT_EQUAL(0, service.pendingSamples());
+    TEST_ASSERT_EQUAL(3, exporter.batches.size());
+    TEST_ASSERT_EQUAL(4, exporter.batches[2]);
+}
+
+void test_backlog_is_exported_in_bounded_batches() {
+    FixedSource source;
+    SensorService service(logger, source);
+    ScriptedExporter exporter;
+    addSensors(service);
+    for (unsigned long tick = 0; tick < 10; tick++) {
+        service.sampleSensors(tick * 5000, SYNCED_EPOCH + tick * 5);
+    }
+    TEST_ASSERT_EQUAL(40, service.pendingSamples());
+
+    service.publishSamples(exporter);
+    TEST_ASSERT_EQUAL(16, service.pendingSamples());
+    service.publishSamples(exporter);
+    TEST_ASSERT_EQUAL(0, service.pendingSamples());
+    TEST_ASSERT_EQUAL(0, service.publishSamples(exporter));
+
+    TEST_ASSERT_EQUAL(2, exporter.batches.size());
+    TEST_ASSERT_EQUAL(24, exporter.batches[0]);
+    TEST_ASSERT_EQUAL(16, exporter.batches[1]);
+}
+
+void test_queue_drops_oldest_beyond_its_bound() {
+    FixedSource source;
+    SensorService service(logger, source);
+    addSensors(service);
+    for (unsigned long tick = 0; tick < 40; tick++) {
+        service.sampleSensors(tick * 5000, SYNCED_EPOCH + tick * 5);
+    }
+
+    TEST_ASSERT_EQUAL(120, service.pendingSamples());
+}
+
+// Until NTP sets the RTC it counts up from 2000-01-01; such readings reach
+// the local snapshot but are never exported.
+void test_readings_before_clock_sync_are_not_queued() {
+    FixedSource source;
+    SensorService service(logger, source);
+    MetricsSnapshot snapshot;
+    addSensors(service);
+    service.setMetricsSnapshot(&snapshot);
+
+    TEST_ASSERT_EQUAL(2, service.sampleSensors(0, 946684800 + 30));
+    TEST_ASSERT_EQUAL(0, service.pendingSamples());
+    TEST_ASSERT_EQUAL(1, snapshot.generation());
+
+    service.sampleSensors(5000, SYNCED_EPOCH);
+    TEST_ASSERT_EQUAL(4, service.pendingSamples());
+}
+
+// No temperature/humidity read shares a tick with a dust read.
+void test_default_periods_keep_reads_off_dust_ticks() {
+    FixedSource source;
+    SensorService service(logger, source);
+    addDefaultSensors(service);
+    service.setSamplingPeriods(120000, 10000, 0);
+    runTicks(service, source, 0, 5000, 720);
+
+    const std::vector<unsigned long> &dust = source.reads["dustsensor1"];
+    TEST_ASSERT_EQUAL(360, dust.size());
+    for (const char *name: {"sensor1", "sensor2", "sensor3"}) {
+        TEST_ASSERT_EQUAL(30, source.reads[name].size());
+        for (unsigned long tick: source.reads[name]) {
+            for (unsigned long dustTick: dust) {
+                TEST_ASSERT_NOT_EQUAL(dustTick, tick);
+            }
+        }
+    }
+}
+
+// An hour of ticks reads every sensor on its own phase, exactly once per
+// period.
+void test_hour_of_ticks_reads_each_sensor_on_schedule() {
+    FixedSource source;
+    SensorService service(logger, source);
+    addDefaultSensors(service);
+    service.setSamplingPeriods(120000, 10000, 0);
+    runTicks(service, source, 0, 5000, 720);
+
+    assertReadEvery(source.reads["dustsensor1"], 10000, 10000, 3600000);
+    assertReadEvery(source.reads["sensor1"], 5000, 120000, 3485000);
+    assertReadEvery(source.reads["sensor2"], 45000, 120000, 3525000);
+    assertReadEvery(source.reads["sensor3"], 85000, 120000, 3565000);
+}
+
+// A sensor that missed several periods (here during a 40 s stall of the tick)
+// is read once when ticks resume and then continues from there, rather than
+// reading on every tick to catch up.
+void test_late_sensor_is_read_once() {
+    FixedSource source;
+    SensorService service(logger, source);
+    addDefaultSensors(service);
+    service.setSamplingPeriods(120000, 10000, 0);
+    runTicks(service, source, 0, 5000, 12);
+
+    // Due: dust at 70 s (30 s late), sensor3 at 85 s (15 s late).
+    source.now = 100000;
+    TEST_ASSERT_EQUAL(2, service.sampleSensors(source.now, SYNCED_EPOCH + 100));
+    runTicks(service, source, 100000, 5000, 12);
+
+    const std::vector<unsigned long> &dust = source.reads["dustsensor1"];
+    assertReadEvery(std::vector<unsigned long>(dust.begin() + 6, dust.end()), 100000, 10000, 160000);
+    assertReadEvery(source.reads["sensor3"], 100000, 120000, 100000);
+}
+
+// The schedule keeps working when the uptime wraps past ULONG_MAX (after
+// ~49.7 days on the board's 32-bit millis()).
+void test_schedule_survives_uptime_rollover() {
+    FixedSource source;
+    SensorService service(logger, source);
+    addDefaultSensors(service);
+    const unsigned long start = ULONG_MAX - 1800000;
+    service.setSamplingPeriods(120000, 10000, start);
+    runTicks(service, source, start, 5000, 720);
+
+    assertReadEvery(source.reads["dustsensor1"], start + 10000, 10000, start + 3600000);
+    assertReadEvery(source.reads["sensor1"], start + 5000, 120000, start + 3485000);
+    assertReadEvery(source.reads["sensor2"], start + 45000, 120000, start + 3525000);
+    assertReadEvery(source.reads["sensor3"], start + 85000, 120000, start + 3565000);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_failed_export_keeps_the_batch);
+    RUN_TEST(test_backlog_is_exported_in_bounded_batches);
+    RUN_TEST(test_queue_drops_oldest_beyond_its_bound);
+    RUN_TEST(test_readings_before_clock_sync_are_not_queued);
+    RUN_TEST(test_default_periods_keep_reads_off_dust_ticks);
+    RUN_TEST(test_hour_of_ticks_reads_each_sensor_on_schedule);
+    RUN_TEST(test_late_sensor_is_read_once);
+    RUN_TEST(test_schedule_survives_uptime_rollover);
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "UdpLineExporter.h"
+
+// Sends through a real loopback socket, so the datagrams the exporter builds
+// are checked on the wire by a local UDP listener.
+class PosixUdp : public UDP {
+public:
+    PosixUdp() : fd(socket(AF_INET, SOCK_DGRAM, 0)) {
+    }
+
+    ~PosixUdp() override {
+        close(fd);
+    }
+
+    int beginPacket(IPAddress ip, uint16_t port) override {
+        packets++;
+        destination = sockaddr_in();
+        destination.sin_family = AF_INET;
+        destination.sin_port = htons(port);
+        uint8_t address[4] = {ip[0], ip[1], ip[2], ip[3]};
+        memcpy(&destination.sin_addr, address, sizeof(address));
+        buffer.clear();
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t size) override {
+        buffer.append((const char *) data, size);
+        return size;
+    }
+
+    int endPacket() override {
+        return sendto(fd, buffer.data(), buffer.size(), 0, (sockaddr *) &destination, sizeof(destination)) ==
+               (ssize_t) buffer.size();
+    }
+
+    int packets = 0;
+
+private:
+    int fd;
+    sockaddr_in destination;
+    std::string buffer;
+};
+
+class LoopbackListener {
+public:
+    LoopbackListener() : fd(socket(AF_INET, SOCK_DGRAM, 0)), port(0) {
+        sockaddr_in address = sockaddr_in();
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd, (sockaddr *) &address, sizeof(address));
+        socklen_t length = sizeof(address);
+        getsockname(fd, (sockaddr *) &address, &length);
+        port = ntohs(address.sin_port);
+
+        timeval timeout = {1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    ~LoopbackListener() {
+        close(fd);
+    }
+
+    bool receive(std::string &datagram) {
+        char buffer[2048];
+        ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+        if (length < 0) {
+            return false;
+        }
+        datagram.assign(buffer, length);
+        return true;
+    }
+
+    int fd;
+    uint16_t port;
+};
+
+static std::vector<MetricPoint> cycle(unsigned long epoch) {
+    return {
+            {"environment.temperature_fahrenheit", 71.25, epoch, "sensor1", "crawlspace"},
+            {"environment.humidity_percent", 45, epoch, "sensor1", "crawlspace"},
+            {"environment.pm2_5_ugm3", 12, epoch, "dustsensor1", "garage"},
+    };
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_merges_fields_of_same_sensor_and_timestamp() {
+    auto datagrams = UdpLineExporter::packDatagrams(cycle(1700000000), UdpLineExporter::DEFAULT_MAX_DATAGRAM);
+
+    TEST_ASSERT_EQUAL(1, datagrams.size());
+    TEST_ASSERT_EQUAL_STRING(
+            "environment,sensor_name=sensor1,location=crawlspace "
+            "temperature_fahrenheit=71.25,humidity_percent=45 1700000000000000000\n"
+            "environment,sensor_name=dustsensor1,location=garage pm2_5_ugm3=12 1700000000000000000\n",
+            datagrams[0].c_str());
+}
+
+void test_different_timestamps_get_separate_lines() {
+    std::vector<MetricPoint> points = {
+            {"environment.pm2_5_ugm3", 12, 1700000000, "dustsensor1", "garage"},
+            {"environment.pm2_5_ugm3", 14, 1700000010, "dustsensor1", "garage"},
+    };
+    auto datagrams = UdpLineExporter::packDatagrams(points, UdpLineExporter::DEFAULT_MAX_DATAGRAM);
+
+    TEST_ASSERT_EQUAL(1, datagrams.size());
+    TEST_ASSERT_EQUAL_STRING(
+            "environment,sensor_name=dustsensor1,location=garage pm2_5_ugm3=12 1700000000000000000\n"
+            "environment,sensor_name=dustsensor1,location=garage pm2_5_ugm3=14 1700000010000000000\n",
+            datagrams[0].c_str());
+}
+
+void test_escapes_tags_and_measurement() {
+    std::vector<MetricPoint> points = {{"env room,a.value", 1, 1, "a=b", "crawl space,north"}};
+    auto datagrams = UdpLineExporter::packDatagrams(points, UdpLineExporter::DEFAULT_MAX_DATAGRAM);
+
+    TEST_ASSERT_EQUAL(1, datagrams.size());
+    TEST_ASSERT_EQUAL_STRING("env\\ room\\,a,sensor_name=a\\=b,location=crawl\\ space\\,north value=1 1000000000\n",
+                             datagrams[0].c_str());
+}
+
+void test_packs_whole_lines_up_to_the_datagram_limit() {
+    std::vector<MetricPoint> points;
+    for (unsigned long i = 0; i < 40; i++) {
+        auto batch = cycle(1700000000 + i);
+        points.insert(points.end(), batch.begin(), batch.end());
+    }
+
+    const size_t limit = 300;
+    auto packed = UdpLineExporter::packDatagrams(points, limit);
+    auto unpacked = UdpLineExporter::packDatagrams(points, 1 << 20);
+
+    TEST_ASSERT_TRUE(packed.size() > 1);
+    std::string joined;
+    for (const auto &datagram: packed) {
+        TEST_ASSERT_TRUE(datagram.size() <= limit);
+        TEST_ASSERT_EQUAL('\n', datagram.back());
+        joined += datagram;
+    }
+    TEST_ASSERT_EQUAL(1, unpacked.size());
+    TEST_ASSERT_EQUAL_STRING(unpacked[0].c_str(), joined.c_str());
+}
+
+void test_oversized_line_is_sent_on_its_own() {
+    auto datagrams = UdpLineExporter::packDatagrams(cycle(1700000000), 10);
+
+    TEST_ASSERT_EQUAL(2, datagrams.size());
+}
+
+void test_sends_datagrams_to_a_local_listener() {
+    LoopbackListener listener;
+    PosixUdp udp;
+    UdpLineExporter exporter(udp, "127.0.0.1", listener.port, 300);
+
+    std::vector<MetricPoint> points;
+    for (unsigned long i = 0; i < 10; i++) {
+        auto batch = cycle(1700000000 + i);
+        points.insert(points.end(), batch.begin(), batch.end());
+    }
+    auto expected = UdpLineExporter::packDatagrams(points, 300);
+
+    TEST_ASSERT_TRUE(exporter.hostValid());
+    TEST_ASSERT_EQUAL((int) expected.size(), exporter.exportMetrics(points));
+    for (const auto &datagram: expected) {
+        std::string received;
+        TEST_ASSERT_TRUE(listener.receive(received));
+        TEST_ASSERT_EQUAL_STRING(datagram.c_str(), received.c_str());
+    }
+}
+
+void test_invalid_host_fails_without_sending() {
+    PosixUdp udp;
+    UdpLineExporter exporter(udp, "10.10.4.2345", 8089);
+
+    TEST_ASSERT_FALSE(exporter.hostValid());
+    TEST_ASSERT_EQUAL(-1, exporter.exportMetrics(cycle(1700000000)));
+    TEST_ASSERT_EQUAL(0, udp.packets);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_merges_fields_of_same_sensor_and_timestamp);
+    RUN_TEST(test_different_timestamps_get_separate_lines);
+    RUN_TEST(test_escapes_tags_and_measurement);
+    RUN_TEST(test_packs_whole_lines_up_to_the_datagram_limit);
+    RUN_TEST(test_oversized_line_is_sent_on_its_own);
+    RUN_TEST(test_sends_datagrams_to_a_local_listener);
+    RUN_TEST(test_invalid_host_fails_without_sending);
+    return UNITY_END();
+}
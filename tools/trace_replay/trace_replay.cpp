@@ -0,0 +1,140 @@
+// Host-side replay driver for sensor traces captured with SENSOR_TRACE_CAPTURE.
+//
+// Drives the firmware's own SensorService from the trace (TraceSensorSource
+// stands in for the sensors) and prints a summary plus a digest of everything
+// it published, so a trace replayed before and after a change must produce the
+// same digest. See docs/TRACING.md for capture and build instructions.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <NullPrint.h>
+#include "SensorService.h"
+#include "SerialLogger.h"
+#include "TraceSensorSource.h"
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Accepts either a raw binary trace or a serial capture, from which the
+// "TRC <hex>" lines are extracted and everything else (regular log output) is
+// ignored. A capture is decoded from its first header record on, so one that
+// started mid-run replays from the writer's next resync.
+static bool loadTrace(const char *path, std::vector<uint8_t> &trace) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (contents.size() >= 5 && contents[0] == TRACE_RECORD_HEADER && contents.compare(1, 4, "ENVT") == 0) {
+        trace.assign(contents.begin(), contents.end());
+        return true;
+    }
+
+    size_t position = 0;
+    std::vector<uint8_t> record;
+    while ((position = contents.find("TRC ", position)) != std::string::npos) {
+        position += 4;
+        record.clear();
+        while (position + 1 < contents.size()) {
+            int high = hexValue(contents[position]);
+            int low = hexValue(contents[position + 1]);
+            if (high < 0 || low < 0) {
+                break;
+            }
+            record.push_back((uint8_t) (high << 4 | low));
+            position += 2;
+        }
+        if (!trace.empty() || (!record.empty() && record[0] == TRACE_RECORD_HEADER)) {
+            trace.insert(trace.end(), record.begin(), record.end());
+        }
+    }
+    return true;
+}
+
+// One pass over the trace with a fresh SensorService, as after a reboot.
+// `output` receives the service's log (the decoded readings at DEBUG level).
+static bool replay(const std::vector<uint8_t> &trace, Print &output, TraceReplayStats &stats, uint64_t &digest) {
+    SerialLogger logger(output);
+    TraceSensorSource source(trace.data(), trace.size());
+    SensorService service(logger, source);
+    TraceDigestExporter exporter;
+
+    bool valid = source.replay(service, exporter);
+    if (!valid) {
+        fprintf(stderr, "Malformed trace record at byte %zu\n", source.errorOffset());
+    }
+    stats = source.stats();
+    digest = exporter.digest();
+    return valid;
+}
+
+int main(int argc, char **argv) {
+    const char *path = nullptr;
+    bool verbose = false;
+    int repeat = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr || repeat < 1) {
+        fprintf(stderr, "usage: %s [-v] [-r repeat] <capture.log|trace.bin>\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> trace;
+    if (!loadTrace(path, trace)) {
+        fprintf(stderr, "Unable to read %s\n", path);
+        return 2;
+    }
+    if (trace.empty()) {
+        fprintf(stderr, "No trace header in %s\n", path);
+        return 1;
+    }
+
+    // Repeats exist only to get a stable throughput figure; every pass must
+    // produce the same digest.
+    NullPrint quiet;
+    TraceReplayStats stats;
+    uint64_t digest = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < repeat; pass++) {
+        uint64_t passDigest;
+        if (!replay(trace, verbose && pass == 0 ? (Print &) Serial : quiet, stats, passDigest)) {
+            return 1;
+        }
+        if (pass > 0 && passDigest != digest) {
+            fprintf(stderr, "Replay is not deterministic (pass %d)\n", pass);
+            return 1;
+        }
+        digest = passDigest;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    unsigned long frames = stats.temperatureHumidityReads + stats.dustReads;
+    printf("cycles: %lu\n", stats.cycles);
+    printf("sht35 reads: %lu (max %u us)\n", stats.temperatureHumidityReads, stats.maxTemperatureHumidityUs);
+    printf("hm3301 reads: %lu (max %u us)\n", stats.dustReads, stats.maxDustUs);
+    printf("read failures: %lu\n", stats.readFailures);
+    printf("checksum failures: %lu\n", stats.checksumFailures);
+    printf("digest: %016llx\n", (unsigned long long) digest);
+    printf("throughput: %.0f frames/s (%zu bytes x %d)\n", seconds > 0 ? frames * repeat / seconds : 0.0,
+           trace.size(), repeat);
+    return 0;
+}